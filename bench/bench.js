@@ -0,0 +1,198 @@
+#!/usr/bin/env node
+
+// Benchmark the sync pipeline stage by stage on synthetic corpora.
+//
+//   npm run bench                                  # 10, 1k, 100k and 1M KRs
+//   npm run bench -- --sizes 10,1000 --json out.json
+//
+// Each stage runs repeatedly for at least --min-time ms (one run minimum) and reports
+// ops/sec, mean/p50/p99 latency and the peak heap seen after each run. Corpora are
+// generated once into --dir and reused.
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { performance } = require('perf_hooks');
+const { execSync } = require('child_process');
+const yaml = require('js-yaml');
+const sync = require('../sync-roadmap');
+const sections = require('../lib/sections');
+const yamlStream = require('../lib/yaml-stream');
+const { csvObjectives } = require('../lib/csv');
+const { generateCorpus } = require('./corpus');
+
+const DEFAULT_SIZES = [10, 1000, 100000, 1000000];
+const DEFAULT_MIN_TIME = 1000;
+// Slow stages stop here even if --min-time has not been reached
+const MAX_ITERATIONS = 10000;
+
+function parseArgs(args) {
+    const options = { sizes: DEFAULT_SIZES, minTime: DEFAULT_MIN_TIME, json: null, dir: path.join(os.tmpdir(), 'kairos-bench') };
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--sizes') {
+            options.sizes = args[++i].split(',').map(Number);
+        } else if (args[i] === '--min-time') {
+            options.minTime = Number(args[++i]);
+        } else if (args[i] === '--dir') {
+            options.dir = args[++i];
+        } else if (args[i] === '--json') {
+            // A file name, or JSON only on stdout when none is given
+            const next = args[i + 1];
+            options.json = next && !next.startsWith('--') ? args[++i] : '-';
+        }
+    }
+    return options;
+}
+
+function percentile(sorted, p) {
+    return sorted[Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1)];
+}
+
+function round(value, digits = 3) {
+    const scale = 10 ** digits;
+    return Math.round(value * scale) / scale;
+}
+
+// Run `fn` until `minTime` has elapsed (at least once) and summarize the samples.
+// `setup` runs untimed before each iteration.
+function measure(stage, fn, { minTime, setup = null }) {
+    if (global.gc) global.gc();
+    const samples = [];
+    let peakHeap = process.memoryUsage().heapUsed;
+    let elapsed = 0;
+    while (samples.length === 0 || (elapsed < minTime && samples.length < MAX_ITERATIONS)) {
+        if (setup) setup();
+        const start = performance.now();
+        fn();
+        const time = performance.now() - start;
+        samples.push(time);
+        elapsed += time;
+        peakHeap = Math.max(peakHeap, process.memoryUsage().heapUsed);
+    }
+    const sorted = samples.slice().sort((a, b) => a - b);
+    const mean = elapsed / samples.length;
+    return {
+        stage,
+        iterations: samples.length,
+        opsPerSec: round(1000 / mean, 2),
+        meanMs: round(mean),
+        p50Ms: round(percentile(sorted, 50)),
+        p99Ms: round(percentile(sorted, 99)),
+        peakHeapMB: round(peakHeap / (1024 * 1024), 1)
+    };
+}
+
+// All stages for one corpus size
+function benchSize(krs, { dir, minTime }) {
+    const template = path.join(__dirname, '..', 'ROADMAP.md');
+    const files = generateCorpus(path.join(dir, String(krs)), krs, template);
+    const yamlBytes = fs.statSync(files.yaml).size;
+    const streamed = yamlBytes > yamlStream.STREAM_THRESHOLD;
+    const roadmap = fs.readFileSync(files.markdown, 'utf8');
+    const workDir = fs.mkdtempSync(path.join(dir, 'run-'));
+    const mdPath = path.join(workDir, 'ROADMAP.md');
+    const outPath = path.join(workDir, 'out.md');
+    const options = { minTime };
+    const stages = [];
+
+    try {
+        let content = null;
+        stages.push(measure('read', () => { content = fs.readFileSync(files.yaml, 'utf8'); }, options));
+        // Files over the streaming threshold are parsed one objective at a time, as
+        // updateRoadmap() does; loading them whole would not fit the default heap
+        let objectives = null;
+        const parse = streamed
+            ? () => { objectives = Array.from(yamlStream.streamRoadmap(files.yaml).objectives); }
+            : () => { objectives = yaml.load(content).objectives; };
+        stages.push({ ...measure('yaml.load', parse, options), streamed });
+        content = null;
+        stages.push(measure('csv', () => {
+            let count = 0;
+            for (const obj of csvObjectives(files.csv)) count += obj.krs.length;
+            return count;
+        }, options));
+        let model = null;
+        stages.push(measure('buildModel', () => { model = sync.buildModel(objectives); }, options));
+        stages.push(measure('generateTimelineChart', () => sync.generateTimelineChart(objectives), options));
+        stages.push(measure('generateLegendTable', () => sync.generateLegendTable(objectives), options));
+        stages.push(measure('generateGanttChart', () => sync.generateGanttChart(objectives), options));
+        objectives = null;
+
+        const charts = sync.renderCharts(model);
+        model = null;
+        const legend = ['\n', ...charts.legend];
+        const regions = {
+            timeline: ['\n```mermaid\n', ...charts.timeline, '```\n'],
+            legend,
+            gantt: ['\n```mermaid\n', ...charts.gantt, '```\n'],
+            'gantt-legend': legend
+        };
+        let spliced = null;
+        stages.push(measure('splice', () => { spliced = sections.splice(sections.tokenize(roadmap), regions); }, options));
+        stages.push(measure('write', () => sections.writeChunks(outPath, spliced.chunks), options));
+        spliced = null;
+
+        const syncOptions = { yamlPath: files.yaml, mdPath, cachePath: path.join(workDir, '.roadmap-cache.json') };
+        const reset = () => {
+            fs.copyFileSync(files.markdown, mdPath);
+            fs.rmSync(syncOptions.cachePath, { force: true });
+        };
+        stages.push(measure('updateRoadmap (cold)', () => sync.updateRoadmap(syncOptions), { minTime, setup: reset }));
+        stages.push(measure('updateRoadmap (unchanged)', () => sync.updateRoadmap(syncOptions), options));
+    } finally {
+        fs.rmSync(workDir, { recursive: true, force: true });
+    }
+    return { krs, yamlBytes, csvBytes: fs.statSync(files.csv).size, stages };
+}
+
+function gitCommit() {
+    try {
+        return execSync('git rev-parse --short HEAD', { cwd: __dirname, stdio: ['ignore', 'pipe', 'ignore'] }).toString().trim();
+    } catch (error) {
+        return null;
+    }
+}
+
+function printResult(result) {
+    console.log(`\n📊 ${result.krs} KRs (okrs.yml ${(result.yamlBytes / 1024).toFixed(0)} KB)`);
+    console.log('  stage                       runs      ops/s    mean ms     p50 ms     p99 ms   heap MB');
+    for (const s of result.stages) {
+        console.log(`  ${s.stage.padEnd(26)}${String(s.iterations).padStart(6)}${String(s.opsPerSec).padStart(11)}` +
+            `${s.meanMs.toFixed(3).padStart(11)}${s.p50Ms.toFixed(3).padStart(11)}${s.p99Ms.toFixed(3).padStart(11)}` +
+            `${s.peakHeapMB.toFixed(1).padStart(10)}`);
+    }
+}
+
+function main(args) {
+    const options = parseArgs(args);
+    const report = {
+        commit: gitCommit(),
+        date: new Date().toISOString(),
+        node: process.version,
+        platform: `${process.platform}-${process.arch}`,
+        cpus: os.cpus().length,
+        minTimeMs: options.minTime,
+        results: []
+    };
+    const quiet = options.json === '-';
+    for (const krs of options.sizes) {
+        const result = benchSize(krs, options);
+        report.results.push(result);
+        if (!quiet) printResult(result);
+    }
+    report.maxRssMB = round(process.resourceUsage().maxRSS / 1024, 1);
+    const json = JSON.stringify(report, null, 2) + '\n';
+    if (quiet) {
+        process.stdout.write(json);
+    } else {
+        console.log(`\nPeak RSS ${report.maxRssMB} MB`);
+        if (options.json) {
+            fs.writeFileSync(options.json, json);
+            console.log(`✅ Results written to ${options.json}`);
+        }
+    }
+}
+
+if (require.main === module) main(process.argv.slice(2));
+
+module.exports = { measure, benchSize };
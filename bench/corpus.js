@@ -0,0 +1,106 @@
+const fs = require('fs');
+const path = require('path');
+const { COLUMNS } = require('../lib/csv');
+
+// Synthetic corpora: objectives of KRS_PER_OBJECTIVE KRs spread over the quarters
+// of 2025, with titles and owners varied enough to exercise interning and escaping
+const KRS_PER_OBJECTIVE = 10;
+const OWNERS = ['Engineering Team', 'QA Team', 'DevOps Team', 'Frontend Team', 'Research Team', 'Community Team'];
+const STATUSES = ['Active', 'Completed', 'Planned'];
+const PRIORITIES = ['High', 'Medium', 'Low'];
+const WORDS = ['NFC', 'auth', 'pipeline', 'wallet', 'firmware', 'ritual', 'designer', 'docs', 'mobile', 'tests',
+    'deploy', 'profiles', 'ESP32', 'governance', 'federation', 'API'];
+
+// Synthetic files are written in chunks of this many objectives
+const FLUSH_EVERY = 500;
+
+function pad(n) {
+    return String(n).padStart(2, '0');
+}
+
+function title(seed, length) {
+    const words = [];
+    for (let i = 0; i < length; i++) words.push(WORDS[(seed * 7 + i * 13) % WORDS.length]);
+    return words.join(' ');
+}
+
+// Objective `o` of a corpus: { id, title, owner, start, end, krs }
+function objective(o, krCount) {
+    const quarter = o % 4;
+    const end = `2025-${pad(quarter * 3 + 3)}-${quarter === 0 || quarter === 3 ? 31 : 30}`;
+    const krs = [];
+    for (let k = 0; k < krCount; k++) {
+        const month = quarter * 3 + 1 + (k % 3);
+        krs.push({
+            id: `O${o + 1}.${k + 1}`,
+            title: `${title(o + k, 4 + (k % 5))} #${k + 1}`,
+            start: `2025-${pad(quarter * 3 + 1)}-01`,
+            end: `2025-${pad(month)}-${pad(10 + (k % 18))}`,
+            progress: (o * 31 + k * 17) % 101,
+            status: STATUSES[(o + k) % STATUSES.length],
+            priority: PRIORITIES[(o * 3 + k) % PRIORITIES.length],
+            owner: OWNERS[(o + k) % OWNERS.length]
+        });
+    }
+    return { id: `O${o + 1}`, title: `Objective ${o + 1}: ${title(o, 5)}`, owner: OWNERS[o % OWNERS.length], end, krs };
+}
+
+function yamlObjective(obj) {
+    const lines = [`  - id: ${obj.id}`, `    title: "${obj.title}"`, `    owner: ${obj.owner}`, `    end: ${obj.end}`, '    krs:'];
+    for (const kr of obj.krs) {
+        lines.push(`      - id: ${kr.id}`, `        title: "${kr.title}"`, `        end: ${kr.end}`);
+    }
+    return lines.join('\n') + '\n';
+}
+
+function csvObjective(obj) {
+    return obj.krs.map(kr => [
+        'Technical', `"${obj.title}"`, `"${kr.title}"`, kr.start, kr.end, kr.progress, kr.status, kr.priority, kr.owner,
+        `"Synthetic task ${kr.id}, generated for benchmarks"`
+    ].join(',') + '\n').join('');
+}
+
+// Write okrs.yml, kairos-okr-data.csv and ROADMAP.md with `krCount` KRs into `dir`,
+// reusing a corpus generated earlier. ROADMAP.md is a copy of the repo's template.
+function generateCorpus(dir, krCount, template) {
+    const files = {
+        yaml: path.join(dir, 'okrs.yml'),
+        csv: path.join(dir, 'kairos-okr-data.csv'),
+        markdown: path.join(dir, 'ROADMAP.md')
+    };
+    const stamp = path.join(dir, '.complete');
+    if (fs.existsSync(stamp)) return files;
+    fs.mkdirSync(dir, { recursive: true });
+    const yamlFd = fs.openSync(files.yaml, 'w');
+    const csvFd = fs.openSync(files.csv, 'w');
+    try {
+        fs.writeSync(yamlFd, 'north_star: >\n  Synthetic benchmark roadmap.\n\nhorizon_2025: 2025-12-31\n\nobjectives:\n');
+        fs.writeSync(csvFd, COLUMNS.join(',') + '\n');
+        let yamlChunk = [];
+        let csvChunk = [];
+        const objectives = Math.ceil(krCount / KRS_PER_OBJECTIVE);
+        for (let o = 0; o < objectives; o++) {
+            const obj = objective(o, Math.min(KRS_PER_OBJECTIVE, krCount - o * KRS_PER_OBJECTIVE));
+            yamlChunk.push(yamlObjective(obj));
+            csvChunk.push(csvObjective(obj));
+            if (yamlChunk.length === FLUSH_EVERY || o === objectives - 1) {
+                fs.writeSync(yamlFd, yamlChunk.join(''));
+                fs.writeSync(csvFd, csvChunk.join(''));
+                yamlChunk = [];
+                csvChunk = [];
+            }
+        }
+    } finally {
+        fs.closeSync(yamlFd);
+        fs.closeSync(csvFd);
+    }
+    fs.copyFileSync(template, files.markdown);
+    fs.writeFileSync(stamp, '');
+    return files;
+}
+
+module.exports = {
+    KRS_PER_OBJECTIVE,
+    objective,
+    generateCorpus
+};
@@ -0,0 +1,16 @@
+const { parentPort } = require('worker_threads');
+const { performance } = require('perf_hooks');
+const { updateRoadmap } = require('../sync-roadmap');
+const { classifyError } = require('./preflight');
+
+// Each worker loads js-yaml and the renderers once, then syncs pairs as they arrive
+parentPort.on('message', job => {
+    const start = performance.now();
+    try {
+        const result = updateRoadmap({ ...job.options, yamlPath: job.yaml, csvPath: job.csv || null, mdPath: job.markdown });
+        parentPort.postMessage({ id: job.id, ok: true, result, ms: performance.now() - start });
+    } catch (error) {
+        const { kind, message } = classifyError(error);
+        parentPort.postMessage({ id: job.id, ok: false, kind, error: message, ms: performance.now() - start });
+    }
+});
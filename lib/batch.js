@@ -0,0 +1,216 @@
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { Worker } = require('worker_threads');
+const { performance } = require('perf_hooks');
+
+// Directories never worth descending into when expanding a glob
+const SKIP_DIRS = new Set(['node_modules', '.git']);
+
+function defaultWorkerCount() {
+    return os.availableParallelism ? os.availableParallelism() : os.cpus().length;
+}
+
+// Minimal glob: `*` and `?` match within a path segment, `**` spans directories
+function globToRegExp(pattern) {
+    let re = '';
+    for (let i = 0; i < pattern.length; i++) {
+        const c = pattern[i];
+        if (c === '*' && pattern[i + 1] === '*') {
+            if (pattern[i + 2] === '/') {
+                re += '(?:.*/)?';
+                i += 2;
+            } else {
+                re += '.*';
+                i += 1;
+            }
+        } else if (c === '*') {
+            re += '[^/]*';
+        } else if (c === '?') {
+            re += '[^/]';
+        } else {
+            re += c.replace(/[.+^${}()|[\]\\]/g, '\\$&');
+        }
+    }
+    return new RegExp(`^${re}$`);
+}
+
+// Files matching `pattern`, walking only below its non-wildcard prefix
+function expandGlob(pattern) {
+    const segments = pattern.split('/');
+    const firstWild = segments.findIndex(s => /[*?]/.test(s));
+    if (firstWild === -1) return fs.existsSync(pattern) ? [pattern] : [];
+    const base = segments.slice(0, firstWild).join('/') || '.';
+    const matcher = globToRegExp(segments.slice(firstWild).join('/'));
+    const matches = [];
+    const walk = (dir, rel) => {
+        let entries;
+        try {
+            entries = fs.readdirSync(dir, { withFileTypes: true });
+        } catch (error) {
+            return;
+        }
+        for (const entry of entries) {
+            const relPath = rel ? `${rel}/${entry.name}` : entry.name;
+            if (entry.isDirectory()) {
+                if (!SKIP_DIRS.has(entry.name)) walk(path.join(dir, entry.name), relPath);
+            } else if (matcher.test(relPath)) {
+                matches.push(path.join(base, relPath));
+            }
+        }
+    };
+    walk(base, '');
+    return matches.sort();
+}
+
+// Read a JSON manifest: [{ "yaml" or "csv": "...", "markdown": "..." }], paths relative to the manifest
+function readManifest(manifestPath) {
+    const dir = path.dirname(manifestPath);
+    const entries = JSON.parse(fs.readFileSync(manifestPath, 'utf8'));
+    if (!Array.isArray(entries)) throw new Error(`${manifestPath} must contain an array of { yaml, markdown } pairs`);
+    return entries.map((entry, i) => {
+        if (!entry || !(entry.yaml || entry.csv) || !entry.markdown) {
+            throw new Error(`${manifestPath} entry ${i} needs "yaml" (or "csv") and "markdown"`);
+        }
+        const source = entry.csv ? { csv: path.resolve(dir, entry.csv) } : { yaml: path.resolve(dir, entry.yaml) };
+        return { ...source, markdown: path.resolve(dir, entry.markdown) };
+    });
+}
+
+// Turn CLI inputs into (yaml or csv, markdown) pairs. A `.json` input is a manifest;
+// anything else is a glob of okrs.yml or CSV files, each paired with ROADMAP.md next to it.
+function resolvePairs(inputs) {
+    const pairs = [];
+    for (const input of inputs) {
+        if (input.endsWith('.json')) {
+            pairs.push(...readManifest(input));
+        } else {
+            for (const sourcePath of expandGlob(input)) {
+                const key = sourcePath.endsWith('.csv') ? 'csv' : 'yaml';
+                pairs.push({ [key]: sourcePath, markdown: path.join(path.dirname(sourcePath), 'ROADMAP.md') });
+            }
+        }
+    }
+    return pairs;
+}
+
+// Sync all pairs across a worker_threads pool; resolves with one result per pair, in input order
+// `options` are passed through to updateRoadmap() for every pair.
+function runBatch(pairs, { workers = defaultWorkerCount(), options = {} } = {}) {
+    const size = Math.max(1, Math.min(workers, pairs.length));
+    const results = new Array(pairs.length);
+    if (pairs.length === 0) return Promise.resolve(results);
+
+    return new Promise((resolve, reject) => {
+        let next = 0;
+        let done = 0;
+        const pool = [];
+        const dispatch = worker => {
+            if (next >= pairs.length) {
+                worker.terminate();
+                return;
+            }
+            const id = next++;
+            worker.postMessage({ id, ...pairs[id], options });
+        };
+        for (let i = 0; i < size; i++) {
+            const worker = new Worker(path.join(__dirname, 'batch-worker.js'));
+            worker.on('message', message => {
+                results[message.id] = { ...pairs[message.id], ...message };
+                done++;
+                if (done === pairs.length) {
+                    pool.forEach(w => w.terminate());
+                    resolve(results);
+                } else {
+                    dispatch(worker);
+                }
+            });
+            worker.on('error', error => {
+                pool.forEach(w => w.terminate());
+                reject(error);
+            });
+            pool.push(worker);
+            dispatch(worker);
+        }
+    });
+}
+
+// Sync flags followed by a value, which must not be taken for inputs
+const VALUE_FLAGS = new Set(['--format', '--shard', '--csv']);
+// Flags that only make sense for a single sync, with the reason they are rejected
+const SINGLE_FLAGS = {
+    '--profile': 'profiling applies to single runs',
+    '--installation': 'each installation is named by its okrs.yml or directory'
+};
+
+// CLI: node sync-roadmap.js --batch [--workers N] [sync flags] <manifest.json | glob>...
+async function main(args) {
+    const { describeResult, parseSyncFlags } = require('../sync-roadmap');
+    const { describeDiff } = require('./diff');
+    const { EXIT, reportError } = require('./preflight');
+    const single = Object.keys(SINGLE_FLAGS).find(flag => args.includes(flag));
+    if (single) {
+        console.error(`❌ ${single} cannot be used with --batch: ${SINGLE_FLAGS[single]}`);
+        process.exitCode = 1;
+        return;
+    }
+    const options = parseSyncFlags(args);
+    let workers = defaultWorkerCount();
+    const inputs = [];
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--workers') {
+            workers = parseInt(args[++i], 10);
+        } else if (VALUE_FLAGS.has(args[i])) {
+            if (args[i + 1] !== undefined && !args[i + 1].startsWith('--')) i++;
+        } else if (!args[i].startsWith('--')) {
+            inputs.push(args[i]);
+        }
+    }
+    if (inputs.length === 0 || !(workers > 0)) {
+        console.error('Usage: node sync-roadmap.js --batch [--workers N] <manifest.json | glob>...');
+        process.exitCode = 1;
+        return;
+    }
+
+    const start = performance.now();
+    let pairs;
+    try {
+        pairs = resolvePairs(inputs);
+    } catch (error) {
+        reportError(error);
+        return;
+    }
+    let results;
+    try {
+        results = await runBatch(pairs, { workers, options });
+    } catch (error) {
+        reportError(error);
+        return;
+    }
+    let failed = 0;
+    let drifted = 0;
+    for (const r of results) {
+        if (r.ok && options.check && r.result.drift) {
+            drifted++;
+            console.log(`❌ ${r.markdown} is out of date [${r.ms.toFixed(1)} ms]`);
+            for (const line of describeDiff(r.result.diff)) console.log(line);
+        } else if (r.ok) {
+            console.log(`✅ ${r.markdown} ${options.check ? 'is up to date' : describeResult(r.result)} [${r.ms.toFixed(1)} ms]`);
+        } else {
+            failed++;
+            console.log(`❌ ${r.markdown} ${r.error} [${r.ms.toFixed(1)} ms]`);
+        }
+    }
+    const elapsed = (performance.now() - start).toFixed(1);
+    console.log(`📦 Synced ${results.length - failed}/${results.length} roadmaps in ${elapsed} ms using ${Math.min(workers, pairs.length)} workers`);
+    if (failed > 0) process.exitCode = 1;
+    else if (drifted > 0) process.exitCode = EXIT.DRIFT;
+}
+
+module.exports = {
+    globToRegExp,
+    expandGlob,
+    resolvePairs,
+    runBatch,
+    main
+};
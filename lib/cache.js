@@ -0,0 +1,133 @@
+const fs = require('fs');
+const crypto = require('crypto');
+
+// Bump whenever the rendered output format changes so stale fragments are dropped
+const CACHE_VERSION = 2;
+
+function hash(content) {
+    return crypto.createHash('sha1').update(content).digest('hex');
+}
+
+// Hash a document given as a chunk list, without joining it
+function hashChunks(chunks) {
+    const h = crypto.createHash('sha1');
+    for (const chunk of chunks) h.update(chunk);
+    return h.digest('hex');
+}
+
+// Hash a file in fixed-size chunks without holding it in memory
+function hashFile(path) {
+    const h = crypto.createHash('sha1');
+    const fd = fs.openSync(path, 'r');
+    const buffer = Buffer.alloc(64 * 1024);
+    try {
+        let bytes;
+        while ((bytes = fs.readSync(fd, buffer, 0, buffer.length, null)) > 0) {
+            h.update(buffer.subarray(0, bytes));
+        }
+    } finally {
+        fs.closeSync(fd);
+    }
+    return h.digest('hex');
+}
+
+// Cheap identity of a file (size and mtime), or null when it can't be read. A changed
+// stamp means the file has to be read or hashed again.
+function fileStamp(path) {
+    try {
+        const stat = fs.statSync(path);
+        return `${stat.size}:${stat.mtimeMs}`;
+    } catch (error) {
+        return null;
+    }
+}
+
+// hashFile() without blocking the event loop
+function hashFileAsync(path) {
+    return new Promise((resolve, reject) => {
+        const h = crypto.createHash('sha1');
+        fs.createReadStream(path, { highWaterMark: 64 * 1024 })
+            .on('data', chunk => h.update(chunk))
+            .on('error', reject)
+            .on('end', () => resolve(h.digest('hex')));
+    });
+}
+
+function emptyManifest() {
+    return { version: CACHE_VERSION, source: null, output: null, objectives: {} };
+}
+
+// Parsed manifest, or an empty one when the text is corrupt or from another version
+function parseManifest(json) {
+    let manifest;
+    try {
+        manifest = JSON.parse(json);
+    } catch (error) {
+        return emptyManifest();
+    }
+    if (!manifest || manifest.version !== CACHE_VERSION || typeof manifest.objectives !== 'object') {
+        return emptyManifest();
+    }
+    return manifest;
+}
+
+// Load the manifest, falling back to an empty one when missing, corrupt or outdated
+function loadManifest(path) {
+    try {
+        return parseManifest(fs.readFileSync(path, 'utf8'));
+    } catch (error) {
+        return emptyManifest();
+    }
+}
+
+// loadManifest() without blocking the event loop
+async function loadManifestAsync(path) {
+    try {
+        return parseManifest(await fs.promises.readFile(path, 'utf8'));
+    } catch (error) {
+        return emptyManifest();
+    }
+}
+
+// On-disk form of a manifest; a manifest that round-trips unchanged serializes the same
+function serializeManifest(manifest) {
+    return JSON.stringify(manifest, null, 2) + '\n';
+}
+
+// Fragment cache for one run over the entries saved last time: looks up by objective
+// content hash, rendering on a miss, and only keeps entries that were used so removed
+// objectives don't accumulate.
+function fragmentCache(previous = {}) {
+    const next = {};
+    let hits = 0;
+    let misses = 0;
+    return {
+        get(key, render) {
+            let fragment = previous[key] || next[key];
+            if (fragment) {
+                hits++;
+            } else {
+                misses++;
+                fragment = render();
+            }
+            next[key] = fragment;
+            return fragment;
+        },
+        entries: () => next,
+        stats: () => ({ hits, misses })
+    };
+}
+
+module.exports = {
+    CACHE_VERSION,
+    hash,
+    hashFile,
+    hashFileAsync,
+    hashChunks,
+    fileStamp,
+    emptyManifest,
+    loadManifest,
+    loadManifestAsync,
+    serializeManifest,
+    fragmentCache
+};
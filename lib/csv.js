@@ -0,0 +1,159 @@
+const fs = require('fs');
+const { StringDecoder } = require('string_decoder');
+const { hash } = require('./cache');
+
+const CHUNK_SIZE = 64 * 1024;
+
+// Columns of kairos-okr-data.csv; sheets may add a Depends On column of KR ids, and
+// ID and Objective ID columns to name KRs and objectives themselves
+const COLUMNS = ['Category', 'Objective', 'Task Name', 'Start Date', 'End Date', 'Progress', 'Status', 'Priority', 'Owner', 'Description'];
+
+// Yield CSV records (arrays of field strings) from a file, reading fixed-size
+// chunks. Handles RFC 4180 quoting: quoted fields may contain commas, doubled
+// quotes and line breaks. Only the current record is held in memory.
+function* readCsvRecords(path) {
+    let record = [];
+    let field = '';
+    let quoted = false;
+    let afterQuote = false;
+    let sawAny = false;
+
+    function* consume(text) {
+        for (let i = 0; i < text.length; i++) {
+            const c = text[i];
+            if (quoted) {
+                if (c === '"') {
+                    quoted = false;
+                    afterQuote = true;
+                } else {
+                    field += c;
+                }
+            } else if (c === '"') {
+                // A quote right after a closing quote is an escaped quote
+                if (afterQuote) field += '"';
+                quoted = true;
+                afterQuote = false;
+                sawAny = true;
+            } else if (c === ',') {
+                record.push(field);
+                field = '';
+                afterQuote = false;
+                sawAny = true;
+            } else if (c === '\n') {
+                record.push(field);
+                // Blank lines are skipped
+                if (sawAny || field !== '') yield record;
+                record = [];
+                field = '';
+                afterQuote = false;
+                sawAny = false;
+            } else if (c !== '\r') {
+                field += c;
+                afterQuote = false;
+                sawAny = true;
+            }
+        }
+    }
+
+    const fd = fs.openSync(path, 'r');
+    const buffer = Buffer.alloc(CHUNK_SIZE);
+    const decoder = new StringDecoder('utf8');
+    try {
+        let bytes;
+        while ((bytes = fs.readSync(fd, buffer, 0, CHUNK_SIZE, null)) > 0) {
+            yield* consume(decoder.write(buffer.subarray(0, bytes)));
+        }
+        yield* consume(decoder.end());
+    } finally {
+        fs.closeSync(fd);
+    }
+    if (quoted) throw new Error(`${path}: unterminated quoted field`);
+    if (sawAny || field !== '') {
+        record.push(field);
+        yield record;
+    }
+}
+
+// Yield one object per data row, keyed by the header row
+function* readCsvRows(path) {
+    let header = null;
+    for (const record of readCsvRecords(path)) {
+        if (!header) {
+            header = record.map(name => name.trim());
+            const missing = ['Objective', 'Task Name'].filter(name => !header.includes(name));
+            if (missing.length > 0) throw new Error(`${path}: missing column(s) ${missing.join(', ')}`);
+            continue;
+        }
+        const row = {};
+        for (let i = 0; i < header.length; i++) row[header[i]] = record[i] === undefined ? '' : record[i].trim();
+        yield row;
+    }
+}
+
+function optional(value) {
+    return value === '' || value === undefined ? undefined : value;
+}
+
+// Id for a row without one: `prefix` and the start of the hash of `name` (Objective,
+// or Objective and Task Name), so it only changes when the names do. A name seen
+// before in `seen` (a reappearing objective, a repeated task) gets a -2, -3, ... suffix.
+function generatedId(seen, prefix, name) {
+    const base = `${prefix}${hash(name).slice(0, 6)}`;
+    const count = (seen.get(base) || 0) + 1;
+    seen.set(base, count);
+    return count === 1 ? base : `${base}-${count}`;
+}
+
+// Stream a kairos-okr-data.csv style sheet as objectives in the same shape okrs.yml
+// produces, so it feeds the same model and renderers. Consecutive rows with the same
+// Objective form one objective; sheets are expected to be grouped by objective, and
+// a name that reappears later starts a new objective. The objective spans its tasks'
+// dates. Ids come from the ID and Objective ID columns when a row has them, and are
+// otherwise derived from the names (see generatedId()), so inserting or reordering rows
+// doesn't rename every later KR.
+function* csvObjectives(path) {
+    let current = null;
+    const objectiveIds = new Map();
+    let krIds = null;
+    for (const row of readCsvRows(path)) {
+        const name = row['Objective'];
+        if (!current || current.title !== name) {
+            if (current) yield current;
+            const id = optional(row['Objective ID']) || generatedId(objectiveIds, 'O', name);
+            current = { id, title: name, owner: optional(row['Owner']), category: optional(row['Category']), krs: [] };
+            krIds = new Map();
+        }
+        const progress = row['Progress'] === undefined || row['Progress'] === '' ? undefined : Number(row['Progress']);
+        const start = optional(row['Start Date']);
+        const end = optional(row['End Date']);
+        current.krs.push({
+            id: optional(row['ID']) || generatedId(krIds, `${current.id}.`, `${name}\n${row['Task Name']}`),
+            title: row['Task Name'],
+            start,
+            end,
+            progress: isNaN(progress) ? undefined : progress,
+            status: optional(row['Status']),
+            priority: optional(row['Priority']),
+            category: optional(row['Category']),
+            owner: optional(row['Owner']),
+            description: optional(row['Description']),
+            depends_on: optional(row['Depends On'])
+        });
+        if (start && (!current.start || start < current.start)) current.start = start;
+        if (end && (!current.end || end > current.end)) current.end = end;
+    }
+    if (current) yield current;
+}
+
+// Same { objectives, rest() } shape as the YAML sources; sheets carry no north star
+function streamCsvRoadmap(path) {
+    return { objectives: csvObjectives(path), rest: () => ({}) };
+}
+
+module.exports = {
+    COLUMNS,
+    readCsvRecords,
+    readCsvRows,
+    csvObjectives,
+    streamCsvRoadmap
+};
@@ -0,0 +1,72 @@
+// Date normalization shared by the renderers. OKR files reuse a handful of
+// quarter-end dates, so each distinct value is parsed once and its
+// YYYY-MM-DD form cached; warm lookups allocate nothing.
+const DAY_MS = 24 * 60 * 60 * 1000;
+
+// Distinct values are few in practice; the cap only guards against pathological input
+const MAX_ENTRIES = 10000;
+
+const byString = new Map();
+const byTime = new Map();
+const byDay = new Map();
+const byQuarter = new Map();
+
+function remember(map, key, value) {
+    if (map.size >= MAX_ENTRIES) map.clear();
+    map.set(key, value);
+    return value;
+}
+
+// Helper to format date as YYYY-MM-DD. Accepts strings or the Date objects
+// js-yaml produces for unquoted dates.
+function formatDate(dateStr) {
+    if (!dateStr) return '';
+    if (dateStr instanceof Date) {
+        const time = dateStr.getTime();
+        const cached = byTime.get(time);
+        return cached !== undefined ? cached : remember(byTime, time, dateStr.toISOString().slice(0, 10));
+    }
+    const cached = byString.get(dateStr);
+    if (cached !== undefined) return cached;
+    return remember(byString, dateStr, new Date(dateStr).toISOString().slice(0, 10));
+}
+
+// Days since 1970-01-01 (UTC) for a date value, or null when missing
+function toEpochDay(value) {
+    if (!value) return null;
+    const time = value instanceof Date ? value.getTime() : Date.parse(formatDate(value));
+    return Math.floor(time / DAY_MS);
+}
+
+function fromEpochDay(day) {
+    return new Date(day * DAY_MS);
+}
+
+// YYYY-MM-DD for an epoch day, cached like formatDate()
+function formatDay(day) {
+    const cached = byDay.get(day);
+    return cached !== undefined ? cached : remember(byDay, day, fromEpochDay(day).toISOString().slice(0, 10));
+}
+
+// { label: '2025-Q3', start } of the quarter an epoch day or YYYY-MM-DD date falls in,
+// with `start` its first epoch day. Cached by value like formatDate(), since charts,
+// rollups and the org-wide merge ask for the same few quarter-end dates over and over.
+function quarterOf(value) {
+    const cached = byQuarter.get(value);
+    if (cached !== undefined) return cached;
+    const date = fromEpochDay(typeof value === 'number' ? value : toEpochDay(value));
+    const quarter = Math.floor(date.getUTCMonth() / 3);
+    return remember(byQuarter, value, {
+        label: `${date.getUTCFullYear()}-Q${quarter + 1}`,
+        start: Math.floor(Date.UTC(date.getUTCFullYear(), quarter * 3, 1) / DAY_MS)
+    });
+}
+
+module.exports = {
+    DAY_MS,
+    formatDate,
+    toEpochDay,
+    fromEpochDay,
+    formatDay,
+    quarterOf
+};
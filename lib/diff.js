@@ -0,0 +1,161 @@
+const { tokenize } = require('./sections');
+
+// Lines of `a` missing from `b`, counted as multisets so moved lines don't count
+function missingLines(a, b) {
+    const counts = new Map();
+    for (const line of b) counts.set(line, (counts.get(line) || 0) + 1);
+    let missing = 0;
+    for (const line of a) {
+        const count = counts.get(line);
+        if (count) counts.set(line, count - 1);
+        else missing++;
+    }
+    return missing;
+}
+
+function regionTexts(doc) {
+    const regions = new Map();
+    for (const part of tokenize(doc)) {
+        if (part.name !== undefined) regions.set(part.name, part.text);
+    }
+    return regions;
+}
+
+// Chart titles name the horizon: "    title KairOS 2024 Timeline"
+const TITLE_RE = /^ {4}title KairOS (.+) (?:Timeline|Gantt Chart)$/;
+
+// Lines of a chart region split per horizon chart, in document order: [{ label, lines }]
+function horizonCharts(text) {
+    const charts = [];
+    for (const line of (text || '').split('\n')) {
+        const m = TITLE_RE.exec(line);
+        if (m) charts.push({ label: m[1], lines: [] });
+        else if (charts.length > 0) charts[charts.length - 1].lines.push(line);
+    }
+    return charts;
+}
+
+// Key of an objective or KR id in chart `i`. Archived horizons repeat ids, so theirs are
+// prefixed with the horizon label; the active horizon (the last chart) keeps bare ids.
+function keyOf(charts, i, id) {
+    return i === charts.length - 1 ? id : `${charts[i].label}/${id}`;
+}
+
+// Per-objective view of the generated regions, keyed as keyOf(): timeline and Gantt
+// blocks by objective, legend rows by KR, and each KR's objective (from the timeline).
+// The legend has no per-horizon markers, but lists the horizons in chart order, so the
+// n-th row of a KR id belongs to the n-th timeline that has it.
+function objectiveBlocks(regions) {
+    const timeline = new Map();
+    const gantt = new Map();
+    const rows = new Map();
+    const krObjective = new Map();
+    const krKeys = new Map();
+    const timelines = horizonCharts(regions.get('timeline'));
+    timelines.forEach((chart, i) => {
+        let current = null;
+        for (const line of chart.lines) {
+            let m;
+            if ((m = /^ {4}(\S+?): /.exec(line))) {
+                current = keyOf(timelines, i, m[1]);
+                timeline.set(current, line);
+            } else if (current && (m = /^ {8}: (\S+) /.exec(line))) {
+                timeline.set(current, `${timeline.get(current)}\n${line}`);
+                const kr = keyOf(timelines, i, m[1]);
+                krObjective.set(kr, current);
+                if (!krKeys.has(m[1])) krKeys.set(m[1], []);
+                krKeys.get(m[1]).push(kr);
+            } else {
+                current = null;
+            }
+        }
+    });
+    const gantts = horizonCharts(regions.get('gantt'));
+    gantts.forEach((chart, i) => {
+        let current = null;
+        for (const line of chart.lines) {
+            const m = /^ {4}section (\S+)/.exec(line);
+            if (m) {
+                current = keyOf(gantts, i, m[1]);
+                gantt.set(current, line);
+            } else if (current && line.startsWith('    ')) {
+                gantt.set(current, `${gantt.get(current)}\n${line}`);
+            } else {
+                current = null;
+            }
+        }
+    });
+    const seen = new Map();
+    for (const line of (regions.get('legend') || '').split('\n')) {
+        const m = /^\| (\S+) \|/.exec(line);
+        if (!m || m[1] === 'ID') continue;
+        const n = seen.get(m[1]) || 0;
+        seen.set(m[1], n + 1);
+        const keys = krKeys.get(m[1]) || [];
+        rows.set(n < keys.length ? keys[n] : `${m[1]}#${n}`, line);
+    }
+    return { timeline, gantt, rows, krObjective };
+}
+
+// Section-level structural diff of two ROADMAP.md texts:
+// { sections: [{ name, status, added, removed }], objectives: { added, removed, changed } }
+// where `added`/`removed` count lines and status is 'changed', 'added' or 'removed'.
+// Objectives are matched by horizon and id across the timeline, Gantt and legend
+// regions; those of archived horizons are reported as `label/id` (2024/Q1).
+function diffDocuments(before, after) {
+    const old = regionTexts(before);
+    const next = regionTexts(after);
+    const sections = [];
+    for (const name of new Set([...old.keys(), ...next.keys()])) {
+        const a = old.get(name);
+        const b = next.get(name);
+        if (a === b) continue;
+        const aLines = a === undefined ? [] : a.split('\n');
+        const bLines = b === undefined ? [] : b.split('\n');
+        sections.push({
+            name,
+            status: a === undefined ? 'added' : b === undefined ? 'removed' : 'changed',
+            added: missingLines(bLines, aLines),
+            removed: missingLines(aLines, bLines)
+        });
+    }
+
+    const was = objectiveBlocks(old);
+    const now = objectiveBlocks(next);
+    const changed = new Set();
+    for (const [id, block] of now.timeline) {
+        if (was.timeline.has(id) && (was.timeline.get(id) !== block || was.gantt.get(id) !== now.gantt.get(id))) changed.add(id);
+    }
+    // Legend-only changes (full titles, due dates of KRs past the chart) count too
+    for (const kr of new Set([...was.rows.keys(), ...now.rows.keys()])) {
+        if (was.rows.get(kr) === now.rows.get(kr)) continue;
+        const id = now.krObjective.get(kr) || was.krObjective.get(kr);
+        if (id && was.timeline.has(id) && now.timeline.has(id)) changed.add(id);
+    }
+    return {
+        sections,
+        objectives: {
+            added: [...now.timeline.keys()].filter(id => !was.timeline.has(id)),
+            removed: [...was.timeline.keys()].filter(id => !now.timeline.has(id)),
+            changed: [...changed]
+        }
+    };
+}
+
+// Console lines for a diffDocuments() result
+function describeDiff(diff) {
+    const lines = diff.sections.map(s => `   ${{ changed: '~', added: '+', removed: '-' }[s.status]} ${s.name} (+${s.added} -${s.removed} lines)`);
+    const { added, removed, changed } = diff.objectives;
+    const objectives = [
+        ...changed.map(id => `~${id}`),
+        ...added.map(id => `+${id}`),
+        ...removed.map(id => `-${id}`)
+    ];
+    if (objectives.length > 0) lines.push(`   objectives: ${objectives.join(' ')}`);
+    return lines;
+}
+
+module.exports = {
+    diffDocuments,
+    describeDiff
+};
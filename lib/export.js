@@ -0,0 +1,142 @@
+const fs = require('fs');
+const path = require('path');
+const zlib = require('zlib');
+const { hash } = require('./cache');
+const io = require('./io');
+const { str, day } = require('./model');
+
+// Export bundle for SDK clients, next to ROADMAP.md. Each format version has its own
+// directory, so clients of an older version keep working while a new one is rolled out:
+//   roadmap-export/v1/index.json                  objectives, their shards and sizes
+//   roadmap-export/v1/objectives/<id>.ndjson      the objective, then one line per KR
+// Every file also has a gzipped copy (.gz) for servers that serve precompressed files.
+// Dates are YYYY-MM-DD, fields without a value are left out of the shard lines, and
+// shard names follow objective ids.
+const EXPORT_DIR = 'roadmap-export';
+const EXPORT_VERSION = 1;
+const SHARD_DIR = 'objectives';
+const SHARD_NAME_RE = /^[\w-]+\.ndjson(\.gz)?$/;
+
+function versionDir(dir) {
+    return path.join(dir, `v${EXPORT_VERSION}`);
+}
+
+// Set `value` on a shard record unless it is missing
+function put(record, key, value) {
+    if (value !== '' && value !== null && !(typeof value === 'number' && isNaN(value))) record[key] = value;
+}
+
+// Stable file name per objective, from its id; repeated ids get -2, -3, ...
+function shardNames(model) {
+    const used = new Set();
+    const names = [];
+    for (let o = 0; o < model.objectiveCount; o++) {
+        const base = str(model, model.objId[o]).replace(/[^\w-]/g, '_') || `objective-${o}`;
+        let name = base;
+        for (let n = 2; used.has(name); n++) name = `${base}-${n}`;
+        used.add(name);
+        names.push(`${name}.ndjson`);
+    }
+    return names;
+}
+
+// NDJSON lines for objective `o`: the objective record { id, title, owner, start, end,
+// krs }, then one { id, title, owner, start, end, progress, status, priority,
+// category, dependsOn } per KR
+function objectiveShard(model, o) {
+    const objective = { id: str(model, model.objId[o]) };
+    put(objective, 'title', str(model, model.objTitle[o]));
+    put(objective, 'owner', str(model, model.objOwner[o]));
+    put(objective, 'start', day(model.objStartDay[o]));
+    put(objective, 'end', day(model.objEndDay[o]));
+    objective.krs = model.objKrOffset[o + 1] - model.objKrOffset[o];
+    const lines = [JSON.stringify(objective)];
+    for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+        const kr = { id: str(model, model.krId[k]) };
+        put(kr, 'title', str(model, model.krTitle[k]));
+        // Owners are inherited from the objective unless the KR has its own
+        if (model.krOwner[k] !== model.objOwner[o]) put(kr, 'owner', str(model, model.krOwner[k]));
+        put(kr, 'start', day(model.krStartDay[k]));
+        put(kr, 'end', day(model.krEndDay[k]));
+        put(kr, 'progress', model.krProgress[k]);
+        put(kr, 'status', str(model, model.krStatus[k]));
+        put(kr, 'priority', str(model, model.krPriority[k]));
+        put(kr, 'category', str(model, model.krCategory[k]));
+        if (model.krDepOffset[k + 1] > model.krDepOffset[k]) {
+            kr.dependsOn = [];
+            for (let j = model.krDepOffset[k]; j < model.krDepOffset[k + 1]; j++) kr.dependsOn.push(str(model, model.krDeps[j]));
+        }
+        lines.push(JSON.stringify(kr));
+    }
+    return lines.join('\n') + '\n';
+}
+
+// Files of the bundle that need writing, relative to the version directory, as
+// [{ file, chunks }] (each followed by its .gz copy), plus the manifest entries for
+// the next run. Shards are keyed by their objective's content hash, so only the
+// objectives that changed since `previous` are serialized and compressed again.
+function exportBundle(model, { dir, label, previous = {} }) {
+    const root = versionDir(dir);
+    const oldShards = (previous.version === EXPORT_VERSION && previous.shards) || {};
+    const shards = {};
+    const files = [];
+    const add = (file, text) => {
+        files.push({ file, chunks: [text] });
+        files.push({ file: `${file}.gz`, chunks: [zlib.gzipSync(text, { level: 9 })] });
+    };
+    const names = shardNames(model);
+    const objectives = [];
+    for (let o = 0; o < model.objectiveCount; o++) {
+        const name = names[o];
+        const file = `${SHARD_DIR}/${name}`;
+        let entry = oldShards[name];
+        if (!entry || entry.key !== model.objHash[o] || !fs.existsSync(path.join(root, file))) {
+            const text = objectiveShard(model, o);
+            entry = { key: model.objHash[o], bytes: Buffer.byteLength(text), hash: hash(text) };
+            add(file, text);
+        }
+        shards[name] = entry;
+        const objective = { id: str(model, model.objId[o]) };
+        put(objective, 'title', str(model, model.objTitle[o]));
+        put(objective, 'start', day(model.objStartDay[o]));
+        put(objective, 'end', day(model.objEndDay[o]));
+        objective.krs = model.objKrOffset[o + 1] - model.objKrOffset[o];
+        Object.assign(objective, { shard: file, bytes: entry.bytes, hash: entry.hash });
+        objectives.push(objective);
+    }
+    const index = JSON.stringify({
+        version: EXPORT_VERSION,
+        label,
+        objectiveCount: model.objectiveCount,
+        krCount: model.krCount,
+        objectives
+    }) + '\n';
+    const indexHash = hash(index);
+    if (indexHash !== previous.index || !fs.existsSync(path.join(root, 'index.json'))) add('index.json', index);
+    for (const entry of files) entry.file = path.join(root, entry.file);
+    return { files, entries: { version: EXPORT_VERSION, index: indexHash, shards } };
+}
+
+// Remove shards of objectives that no longer exist, with `remove(file)`
+function pruneBundle(dir, entries, remove = io.removeSync) {
+    const shardDir = path.join(versionDir(dir), SHARD_DIR);
+    if (!fs.existsSync(shardDir)) return;
+    for (const name of fs.readdirSync(shardDir)) {
+        if (SHARD_NAME_RE.test(name) && !entries.shards[name.replace(/\.gz$/, '')]) remove(path.join(shardDir, name));
+    }
+}
+
+// Whether the bundle recorded in the manifest is still on disk
+function bundleCurrent(dir, entries) {
+    return !!entries && entries.version === EXPORT_VERSION && fs.existsSync(path.join(versionDir(dir), 'index.json'));
+}
+
+module.exports = {
+    EXPORT_DIR,
+    EXPORT_VERSION,
+    versionDir,
+    objectiveShard,
+    exportBundle,
+    pruneBundle,
+    bundleCurrent
+};
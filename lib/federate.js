@@ -0,0 +1,216 @@
+const fs = require('fs');
+const path = require('path');
+const cache = require('./cache');
+const io = require('./io');
+const { Heap } = require('./heap');
+const sections = require('./sections');
+const { expandGlob } = require('./batch');
+const { FILTERS } = require('./templates');
+const { NO_DAY, str, day } = require('./model');
+const { quarterOf } = require('./dates');
+const { emptyTotals, addTotals, summarize } = require('./rollups');
+
+// Each installation's sync can write a summary next to its ROADMAP.md (--summary):
+// its KRs pre-sorted by due date, and its additive rollup totals. The org-wide
+// roadmap is then a k-way merge of the summaries, so a change in one installation
+// costs that installation's sync plus a merge, not a re-sync of everything.
+const SUMMARY_FILE = 'roadmap-summary.json';
+const SUMMARY_VERSION = 1;
+// Stamps of the summaries merged last time, next to the org ROADMAP.md
+const FEDERATION_FILE = '.roadmap-federation.json';
+const UNSCHEDULED = 'Unscheduled';
+
+// Summary of one installation: { version, installation, label, asOf, objectives,
+// krs, totals, quarters } where krs are [due, id, title, objective index] sorted by
+// due date (undated last), then id. Due dates fall back to the objective's end, as
+// in the Gantt chart. `rollups` are the per-objective rollups of the sync.
+function buildSummary(model, rollups, { installation, label, asOf }) {
+    const due = new Int32Array(model.krCount);
+    for (let k = 0; k < model.krCount; k++) {
+        due[k] = model.krEndDay[k] !== NO_DAY ? model.krEndDay[k] : model.objEndDay[model.krObjective[k]];
+    }
+    const ids = Array.from(model.krId, index => str(model, index));
+    const order = Array.from({ length: model.krCount }, (_, k) => k).sort((a, b) =>
+        (due[a] === NO_DAY) - (due[b] === NO_DAY) || due[a] - due[b] || (ids[a] < ids[b] ? -1 : ids[a] > ids[b] ? 1 : a - b));
+    const totals = emptyTotals();
+    const quarters = {};
+    for (const rollup of rollups) {
+        addTotals(totals, rollup.totals);
+        for (const [quarter, partial] of Object.entries(rollup.quarters)) {
+            addTotals(quarters[quarter] || (quarters[quarter] = emptyTotals()), partial);
+        }
+    }
+    const objectives = [];
+    for (let o = 0; o < model.objectiveCount; o++) {
+        objectives.push({ id: str(model, model.objId[o]), title: str(model, model.objTitle[o]), active: rollups[o].active });
+    }
+    return {
+        version: SUMMARY_VERSION,
+        installation,
+        label,
+        asOf,
+        objectives,
+        krs: order.map(k => [day(due[k]) || null, ids[k], str(model, model.krTitle[k]), model.krObjective[k]]),
+        totals,
+        quarters
+    };
+}
+
+// On-disk form of a summary, one KR per line so small edits keep small git diffs
+function serializeSummary(summary) {
+    const { krs, ...rest } = summary;
+    const head = JSON.stringify(rest);
+    const rows = krs.map(kr => JSON.stringify(kr)).join(',\n');
+    return `${head.slice(0, -1)},"krs":[\n${rows}\n]}\n`;
+}
+
+// Sort key of an undated KR, after every YYYY-MM-DD date
+const LAST = '~';
+
+// Call visit(summary, kr) for every KR of the summaries in due-date order: a k-way
+// merge of the pre-sorted lists, O(n log k) for n KRs over k installations. Ties keep
+// the order the summaries were given in.
+function mergeSummaries(summaries, visit) {
+    const before = (a, b) => (a.key !== b.key ? a.key < b.key : a.s < b.s);
+    const heap = new Heap(before);
+    summaries.forEach((summary, s) => {
+        if (summary.krs.length > 0) heap.push({ s, i: 0, key: summary.krs[0][0] || LAST });
+    });
+    while (heap.size > 0) {
+        const cursor = heap.peek();
+        const krs = summaries[cursor.s].krs;
+        visit(summaries[cursor.s], krs[cursor.i]);
+        if (++cursor.i < krs.length) {
+            cursor.key = krs[cursor.i][0] || LAST;
+            heap.replaceTop(cursor);
+        } else {
+            heap.pop();
+        }
+    }
+}
+
+// Org-wide timeline (one period per due quarter), legend and per-installation
+// progress, from one pass over the merged KRs
+function renderFederation(summaries, title) {
+    const timeline = [`timeline\n    title ${title} Timeline\n`];
+    const legend = ['\n| Installation | ID | Full Task Name | Due Date |\n|--------------|----|----------------|----------|\n'];
+    let period = null;
+    const names = new Map(summaries.map(summary => [summary, FILTERS.cell(summary.installation)]));
+    mergeSummaries(summaries, (summary, kr) => {
+        const [due, id, krTitle] = kr;
+        const quarter = due ? quarterOf(due).label : UNSCHEDULED;
+        if (quarter !== period) {
+            timeline.push(`    ${quarter}: Due in ${quarter}\n`);
+            period = quarter;
+        }
+        timeline.push(`        : ${summary.installation} ${id} ${FILTERS.short(krTitle)}\n`);
+        legend.push(`| ${names.get(summary)} | ${id} | ${FILTERS.cell(krTitle)} | ${due || ''} |\n`);
+    });
+    const installations = ['\n| Installation | Objectives | KRs | Completed | Progress |\n|--------------|------------|-----|-----------|----------|\n'];
+    const org = emptyTotals();
+    let objectiveCount = 0;
+    const row = (name, objectives, totals) => {
+        const stats = summarize(totals);
+        const progress = stats.progress === null ? '' : `${stats.progress}%`;
+        return `| ${name} | ${objectives} | ${stats.keyResults} | ${stats.completed} | ${progress} |\n`;
+    };
+    for (const summary of summaries) {
+        addTotals(org, summary.totals);
+        objectiveCount += summary.objectives.length;
+        installations.push(row(FILTERS.cell(summary.installation), summary.objectives.length, summary.totals));
+    }
+    installations.push(row('**All**', objectiveCount, org));
+    return {
+        timeline: ['\n```mermaid\n', ...timeline, '```\n'],
+        legend,
+        installations
+    };
+}
+
+// Read a summary, checking it is one this version can merge
+function readSummary(file) {
+    const summary = JSON.parse(fs.readFileSync(file, 'utf8'));
+    if (!summary || summary.version !== SUMMARY_VERSION || !Array.isArray(summary.krs)) {
+        throw new Error(`${file} is not a version ${SUMMARY_VERSION} roadmap summary; re-run its sync with --summary`);
+    }
+    return summary;
+}
+
+// Merge installation summaries into the timeline, legend and (optional) installations
+// regions of the org-wide `mdPath`. Nothing is read but stats when no summary changed
+// and the document is what was written last; otherwise only changed summaries are
+// parsed again when `state` carries the previous ones (watch-style callers).
+function federate({
+    summaries: files,
+    mdPath = 'ROADMAP.md',
+    cachePath = path.join(path.dirname(mdPath), FEDERATION_FILE),
+    title = 'KairOS Organization',
+    state = null,
+    write = io.writeAtomicSync
+}) {
+    const stamps = {};
+    for (const file of files) stamps[file] = cache.fileStamp(file);
+    let manifest = {};
+    try {
+        manifest = JSON.parse(fs.readFileSync(cachePath, 'utf8'));
+    } catch (error) {
+        // First run, or a corrupt manifest: merge from scratch
+    }
+    const roadmap = fs.readFileSync(mdPath, 'utf8');
+    const outputHash = cache.hash(roadmap);
+    const sameStamps = manifest.stamps && Object.keys(manifest.stamps).length === files.length &&
+        files.every(file => manifest.stamps[file] === stamps[file]);
+    if (sameStamps && manifest.output === outputHash) return { changed: [], installations: files.length, read: 0 };
+
+    const loaded = (state && state.summaries) || new Map();
+    let read = 0;
+    const summaries = files.map(file => {
+        const previous = loaded.get(file);
+        if (previous && previous.stamp === stamps[file]) return previous.summary;
+        read++;
+        const summary = readSummary(file);
+        loaded.set(file, { stamp: stamps[file], summary });
+        return summary;
+    });
+    for (const file of loaded.keys()) if (!(file in stamps)) loaded.delete(file);
+    if (state) state.summaries = loaded;
+
+    const regions = renderFederation(summaries, title);
+    const result = sections.updateFile(mdPath, regions, roadmap, { optional: ['installations'], write });
+    write(cachePath, [JSON.stringify({ stamps, output: cache.hashChunks(result.chunks) }) + '\n']);
+    return { changed: result.changed, installations: files.length, read };
+}
+
+// CLI: node sync-roadmap.js --federate [--markdown ORG.md] <summary.json | glob>...
+function main(args) {
+    const { reportError } = require('./preflight');
+    const inputs = [];
+    let mdPath = 'ROADMAP.md';
+    for (let i = 0; i < args.length; i++) {
+        if (args[i] === '--markdown') mdPath = args[++i];
+        else if (!args[i].startsWith('--')) inputs.push(args[i]);
+    }
+    const files = inputs.flatMap(input => (/[*?]/.test(input) ? expandGlob(input) : [input]));
+    if (files.length === 0) {
+        console.error('Usage: node sync-roadmap.js --federate [--markdown ORG-ROADMAP.md] <roadmap-summary.json | glob>...');
+        process.exitCode = 1;
+        return;
+    }
+    try {
+        const result = federate({ summaries: files, mdPath });
+        const summary = result.changed.length === 0 ? 'already up to date' : `updated (${result.changed.join(', ')})`;
+        console.log(`✅ ${mdPath} ${summary} from ${result.installations} installations`);
+    } catch (error) {
+        reportError(error);
+    }
+}
+
+module.exports = {
+    SUMMARY_FILE,
+    buildSummary,
+    serializeSummary,
+    mergeSummaries,
+    renderFederation,
+    federate,
+    main
+};
@@ -0,0 +1,245 @@
+const fs = require('fs');
+const path = require('path');
+const { hash } = require('./cache');
+const { writeAtomicSync } = require('./io');
+const { NO_STRING, str, day } = require('./model');
+
+// Issue mapping, KR content hashes and list-page ETags from the last run, next to okrs.yml
+const STATE_FILE = '.roadmap-github.json';
+const STATE_VERSION = 1;
+const API_URL = 'https://api.github.com';
+const LABEL = 'okr';
+// KR issues per GraphQL mutation; larger batches run into GitHub's secondary limits
+const BATCH_SIZE = 50;
+const MARKER_RE = /<!-- okr:kr:(.+?) -->/;
+
+function emptyState(repo) {
+    return { version: STATE_VERSION, repo, repositoryId: null, labelId: null, items: {}, pages: [] };
+}
+
+function loadState(file, repo) {
+    try {
+        const state = JSON.parse(fs.readFileSync(file, 'utf8'));
+        if (state && state.version === STATE_VERSION && state.repo === repo) return state;
+    } catch (error) {
+        // First run
+    }
+    return emptyState(repo);
+}
+
+// Issue title, body and open/closed state for KR `k`
+function krIssue(model, k) {
+    const o = model.krObjective[k];
+    const id = str(model, model.krId[k]);
+    const field = (label, value) => (value ? `**${label}**: ${value}\n` : '');
+    const progress = model.krProgress[k];
+    const status = model.krStatus[k] === NO_STRING ? '' : str(model, model.krStatus[k]);
+    const description = model.krDescription[k] === NO_STRING ? '' : `\n${str(model, model.krDescription[k])}\n`;
+    const body = `<!-- okr:kr:${id} -->\n` +
+        field('Objective', `${str(model, model.objId[o])} ${str(model, model.objTitle[o])}`) +
+        field('Due', day(model.krEndDay[k])) +
+        field('Owner', str(model, model.krOwner[k])) +
+        field('Progress', isNaN(progress) ? '' : `${progress}%`) +
+        field('Status', status) +
+        description +
+        '\n_Synced from the OKR source by sync-roadmap.js; edits to this description are overwritten._\n';
+    return {
+        id,
+        title: `${id}: ${str(model, model.krTitle[k])}`,
+        body,
+        closed: status === 'Completed' || progress >= 100
+    };
+}
+
+// fetch() wrapper that counts requests and turns API failures into errors
+function apiClient(token, fetchImpl) {
+    let requests = 0;
+    async function call(method, url, { body, headers = {} } = {}) {
+        requests++;
+        const response = await fetchImpl(url.startsWith('http') ? url : `${API_URL}${url}`, {
+            method,
+            headers: {
+                Accept: 'application/vnd.github+json',
+                Authorization: `Bearer ${token}`,
+                'User-Agent': 'kairos-sync-roadmap',
+                ...(body ? { 'Content-Type': 'application/json' } : {}),
+                ...headers
+            },
+            body: body ? JSON.stringify(body) : undefined
+        });
+        if (response.status === 304) return { status: 304, headers: response.headers, data: null };
+        const data = await response.json().catch(() => null);
+        if (!response.ok) throw new Error(`GitHub API ${method} ${url}: ${response.status} ${(data && data.message) || ''}`.trim());
+        return { status: response.status, headers: response.headers, data };
+    }
+    async function graphql(query, variables) {
+        const { data } = await call('POST', '/graphql', { body: { query, variables } });
+        if (data.errors && data.errors.length > 0) throw new Error(`GitHub GraphQL: ${data.errors.map(e => e.message).join('; ')}`);
+        return data.data;
+    }
+    return { call, graphql, requests: () => requests };
+}
+
+// Repository and label node ids, looked up once and kept in the state file
+async function ensureRepository(api, state, owner, name) {
+    if (state.repositoryId && state.labelId) return;
+    const query = 'query($owner: String!, $name: String!, $label: String!) { repository(owner: $owner, name: $name) { id label(name: $label) { id } } }';
+    let { repository } = await api.graphql(query, { owner, name, label: LABEL });
+    if (!repository.label) {
+        await api.call('POST', `/repos/${owner}/${name}/labels`, { body: { name: LABEL, color: '667eea', description: 'Key result synced from the OKR roadmap' } });
+        ({ repository } = await api.graphql(query, { owner, name, label: LABEL }));
+    }
+    state.repositoryId = repository.id;
+    state.labelId = repository.label.id;
+}
+
+// KR id -> { number, nodeId } for every issue carrying the okr label. Pages are
+// fetched with If-None-Match, so unchanged pages come back as free 304s.
+async function discoverIssues(api, state, owner, name) {
+    const found = {};
+    const pages = [];
+    let url = `/repos/${owner}/${name}/issues?labels=${LABEL}&state=all&per_page=100`;
+    for (let page = 0; url; page++) {
+        const cached = state.pages[page];
+        const headers = cached && cached.url === url && cached.etag ? { 'If-None-Match': cached.etag } : {};
+        const response = await api.call('GET', url, { headers });
+        let entry;
+        if (response.status === 304) {
+            entry = cached;
+        } else {
+            const issues = response.data
+                .filter(issue => !issue.pull_request)
+                .map(issue => ({ match: MARKER_RE.exec(issue.body || ''), number: issue.number, nodeId: issue.node_id }))
+                .filter(issue => issue.match)
+                .map(issue => ({ id: issue.match[1], number: issue.number, nodeId: issue.nodeId }));
+            const next = /<([^>]+)>;\s*rel="next"/.exec(response.headers.get('link') || '');
+            entry = { url, etag: response.headers.get('etag'), next: next ? next[1] : null, issues };
+        }
+        pages.push(entry);
+        for (const issue of entry.issues) found[issue.id] = { number: issue.number, nodeId: issue.nodeId };
+        url = entry.next;
+    }
+    state.pages = pages;
+    return found;
+}
+
+// Create and update issues with one aliased GraphQL mutation per batch
+async function pushIssues(api, state, changes) {
+    for (let i = 0; i < changes.length; i += BATCH_SIZE) {
+        const batch = changes.slice(i, i + BATCH_SIZE);
+        const variables = {};
+        const declarations = [];
+        const fields = [];
+        batch.forEach((change, j) => {
+            const { issue, item } = change;
+            if (item) {
+                variables[`i${j}`] = { id: item.nodeId, title: issue.title, body: issue.body, state: issue.closed ? 'CLOSED' : 'OPEN' };
+                declarations.push(`$i${j}: UpdateIssueInput!`);
+                fields.push(`k${j}: updateIssue(input: $i${j}) { issue { id number } }`);
+            } else {
+                variables[`i${j}`] = { repositoryId: state.repositoryId, title: issue.title, body: issue.body, labelIds: [state.labelId] };
+                declarations.push(`$i${j}: CreateIssueInput!`);
+                fields.push(`k${j}: createIssue(input: $i${j}) { issue { id number } }`);
+            }
+        });
+        const data = await api.graphql(`mutation(${declarations.join(', ')}) { ${fields.join(' ')} }`, variables);
+        batch.forEach((change, j) => {
+            const result = data[`k${j}`].issue;
+            change.item = { number: result.number, nodeId: result.id };
+        });
+    }
+    // createIssue can't set the state, so completed KRs get their new issue closed in a
+    // follow-up round of updates
+    const toClose = changes.filter(change => change.created && change.issue.closed);
+    if (toClose.length > 0) await pushIssues(api, state, toClose.map(change => ({ issue: change.issue, item: change.item })));
+}
+
+// Mirror every KR to a labelled issue in `repo` (owner/name). Only KRs whose content
+// hash changed since the last run are written; KRs without a known issue trigger one
+// conditional scan of the labelled issues first. `dryRun` reports without any calls.
+async function syncGithub({
+    yamlPath = 'okrs.yml',
+    csvPath = null,
+    repo = process.env.GITHUB_REPOSITORY,
+    token = process.env.GITHUB_TOKEN,
+    statePath = path.join(path.dirname(csvPath || yamlPath), STATE_FILE),
+    dryRun = false,
+    fetch: fetchImpl = globalThis.fetch,
+    ...options
+} = {}) {
+    const { loadModel } = require('../sync-roadmap');
+    if (!repo || !/^[\w.-]+\/[\w.-]+$/.test(repo)) throw new Error('GitHub sync needs --repo owner/name (or $GITHUB_REPOSITORY)');
+    if (!token && !dryRun) throw new Error('GitHub sync needs a token in $GITHUB_TOKEN');
+    const [owner, name] = repo.split('/');
+    const model = loadModel({ yamlPath, csvPath, ...options });
+    const state = loadState(statePath, repo);
+
+    const changes = [];
+    const hashes = {};
+    for (let k = 0; k < model.krCount; k++) {
+        const issue = krIssue(model, k);
+        const contentHash = hash(JSON.stringify(issue));
+        hashes[issue.id] = contentHash;
+        const item = state.items[issue.id];
+        if (!item || item.hash !== contentHash) changes.push({ issue, item: item || null, hash: contentHash });
+    }
+    const summary = { krs: model.krCount, created: 0, updated: 0, unchanged: model.krCount - changes.length, requests: 0 };
+    if (dryRun || changes.length === 0) {
+        summary.created = changes.filter(change => !change.item).length;
+        summary.updated = changes.length - summary.created;
+        return summary;
+    }
+
+    const api = apiClient(token, fetchImpl);
+    await ensureRepository(api, state, owner, name);
+    if (changes.some(change => !change.item)) {
+        const found = await discoverIssues(api, state, owner, name);
+        for (const change of changes) {
+            if (!change.item && found[change.issue.id]) change.item = found[change.issue.id];
+        }
+    }
+    for (const change of changes) {
+        change.created = !change.item;
+        if (change.created) summary.created++;
+        else summary.updated++;
+    }
+    try {
+        await pushIssues(api, state, changes);
+    } finally {
+        // Record whatever was pushed, so a failed batch is retried next time without
+        // creating duplicates of the issues that did get through
+        for (const change of changes) {
+            if (change.item && change.item.nodeId) state.items[change.issue.id] = { ...change.item, hash: change.hash };
+        }
+        for (const id of Object.keys(state.items)) {
+            if (!(id in hashes)) delete state.items[id];
+        }
+        writeAtomicSync(statePath, [JSON.stringify(state, null, 2) + '\n']);
+    }
+    summary.requests = api.requests();
+    return summary;
+}
+
+// CLI: node sync-roadmap.js --github --repo owner/name [--dry-run] [--csv path]
+function main(args) {
+    const { parseSyncFlags } = require('../sync-roadmap');
+    const { reportError } = require('./preflight');
+    const repoIndex = args.indexOf('--repo');
+    const options = {
+        ...parseSyncFlags(args),
+        dryRun: args.includes('--dry-run'),
+        ...(repoIndex !== -1 ? { repo: args[repoIndex + 1] } : {})
+    };
+    syncGithub(options).then(summary => {
+        const verb = options.dryRun ? 'would push' : 'pushed';
+        console.log(`✅ GitHub ${verb} ${summary.created} new and ${summary.updated} changed KRs ` +
+            `(${summary.unchanged}/${summary.krs} unchanged, ${summary.requests} API requests)`);
+    }, reportError);
+}
+
+module.exports = {
+    STATE_FILE,
+    krIssue,
+    syncGithub,
+    main
+};
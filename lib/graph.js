@@ -0,0 +1,327 @@
+const { hash } = require('./cache');
+const { toEpochDay, quarterOf } = require('./dates');
+const { Heap } = require('./heap');
+const { NO_DAY, DataError, str, day } = require('./model');
+
+// " → "-joined KR ids of a cycle among the KRs Kahn's algorithm couldn't order
+function findCycle(model, preds, remaining) {
+    const onPath = new Map();
+    const path = [];
+    const done = new Set();
+    const visit = k => {
+        onPath.set(k, path.length);
+        path.push(k);
+        for (const p of preds[k]) {
+            if (!remaining[p] || done.has(p)) continue;
+            if (onPath.has(p)) return path.slice(onPath.get(p)).concat(p);
+            const cycle = visit(p);
+            if (cycle) return cycle;
+        }
+        onPath.delete(path.pop());
+        done.add(k);
+        return null;
+    };
+    for (let k = 0; k < remaining.length; k++) {
+        if (!remaining[k] || done.has(k)) continue;
+        const cycle = visit(k);
+        // Walked along depends_on, so reverse to read in execution order
+        if (cycle) return cycle.reverse().map(i => str(model, model.krId[i])).join(' → ');
+    }
+    return '';
+}
+
+// Dependency graph over the KRs' `depends_on` ids, with the projected schedule.
+// A KR starts when its latest dependency finishes (or at its own start, if later)
+// and keeps its planned duration, so a late upstream end pushes everything after
+// it. KRs without an explicit start are planned to start when their dependencies
+// are planned to end. Throws DataError for unknown ids and cycles.
+//
+// start/end are the projected days, plannedStart/plannedEnd the baseline from the
+// source, and critical flags the chain of binding dependencies that ends last.
+// setEnd() and addDependency() replan in place, touching only the KRs downstream of
+// the edit. Durations and the baseline are fixed when the graph is built, so an edit
+// pushes later KRs back instead of shortening them, and slip stays measured against
+// the source.
+function createGraph(model) {
+    const n = model.krCount;
+    const byId = new Map();
+    for (let k = 0; k < n; k++) {
+        if (!byId.has(model.krId[k])) byId.set(model.krId[k], k);
+    }
+    const preds = [];
+    const succs = [];
+    for (let k = 0; k < n; k++) {
+        preds.push([]);
+        succs.push([]);
+    }
+    let edges = 0;
+    for (let k = 0; k < n; k++) {
+        for (let j = model.krDepOffset[k]; j < model.krDepOffset[k + 1]; j++) {
+            const dep = byId.get(model.krDeps[j]);
+            const id = str(model, model.krId[k]);
+            if (dep === undefined) throw new DataError(`${id} depends on unknown KR "${str(model, model.krDeps[j])}"`);
+            if (dep === k) throw new DataError(`${id} depends on itself`);
+            if (preds[k].includes(dep)) continue;
+            preds[k].push(dep);
+            succs[dep].push(k);
+            edges++;
+        }
+    }
+
+    // Topological order (Kahn), and each KR's position in it
+    const order = new Int32Array(n);
+    const position = new Int32Array(n);
+    const pending = new Int32Array(n);
+    let length = 0;
+    for (let k = 0; k < n; k++) {
+        pending[k] = preds[k].length;
+        if (pending[k] === 0) order[length++] = k;
+    }
+    for (let i = 0; i < length; i++) {
+        const k = order[i];
+        position[k] = i;
+        for (const s of succs[k]) {
+            if (--pending[s] === 0) order[length++] = s;
+        }
+    }
+    if (length < n) {
+        const remaining = Array.from(pending, count => count > 0);
+        throw new DataError(`Dependency cycle: ${findCycle(model, preds, remaining)}`);
+    }
+
+    // Planned dates, the same ones the Gantt bars use
+    const plannedEnd = new Int32Array(n);
+    const plannedStart = new Int32Array(n);
+    const duration = new Int32Array(n);
+    for (let k = 0; k < n; k++) {
+        const o = model.krObjective[k];
+        plannedEnd[k] = model.krEndDay[k] !== NO_DAY ? model.krEndDay[k] : model.objEndDay[o];
+    }
+    // Planned start and duration of KR k, from the planned ends of its dependencies
+    // in the source
+    function plan(k) {
+        const end = plannedEnd[k];
+        let start = model.krStartDay[k];
+        if (start === NO_DAY) {
+            for (const p of preds[k]) {
+                if (plannedEnd[p] !== NO_DAY && (start === NO_DAY || plannedEnd[p] > start)) start = plannedEnd[p];
+            }
+        }
+        if (start === NO_DAY) start = model.objStartDay[model.krObjective[k]];
+        if (start === NO_DAY && end !== NO_DAY) start = quarterOf(end).start;
+        plannedStart[k] = start;
+        duration[k] = end === NO_DAY || start === NO_DAY ? 0 : Math.max(0, end - start);
+    }
+    for (let k = 0; k < n; k++) plan(k);
+
+    const start = new Int32Array(n).fill(NO_DAY);
+    const end = new Int32Array(n).fill(NO_DAY);
+    // Dependency whose end sets each KR's start, or -1
+    const binding = new Int32Array(n).fill(-1);
+    const critical = new Uint8Array(n);
+
+    // Projected dates of KR k from its dependencies'; true if they moved
+    function relax(k) {
+        const previousStart = start[k];
+        const previousEnd = end[k];
+        binding[k] = -1;
+        if (plannedEnd[k] === NO_DAY) {
+            start[k] = NO_DAY;
+            end[k] = NO_DAY;
+        } else {
+            let s = plannedStart[k];
+            for (const p of preds[k]) {
+                if (end[p] === NO_DAY || end[p] < s) continue;
+                if (end[p] > s || binding[k] === -1) binding[k] = p;
+                s = end[p];
+            }
+            start[k] = s;
+            end[k] = s + duration[k];
+        }
+        return start[k] !== previousStart || end[k] !== previousEnd;
+    }
+
+    function linked(k) {
+        return preds[k].length > 0 || succs[k].length > 0;
+    }
+
+    // Flag the chain of binding dependencies behind the latest projected end
+    function markCritical() {
+        critical.fill(0);
+        let last = -1;
+        for (let k = 0; k < n; k++) {
+            if (!linked(k) || end[k] === NO_DAY) continue;
+            if (last === -1 || end[k] > end[last] || (end[k] === end[last] && position[k] > position[last])) last = k;
+        }
+        for (let k = last; k !== -1; k = binding[k]) critical[k] = 1;
+    }
+
+    // Re-relax the `seeds` and everything downstream whose dates move; returns the
+    // KRs changed. The critical path is then re-marked with one scan.
+    function propagate(seeds) {
+        // KRs come out in topological order, so each affected KR is relaxed once
+        const heap = new Heap((a, b) => position[a] < position[b]);
+        const queued = new Set(seeds);
+        const changed = [];
+        for (const k of seeds) heap.push(k);
+        while (heap.size > 0) {
+            const k = heap.pop();
+            if (!relax(k)) continue;
+            changed.push(k);
+            for (const s of succs[k]) {
+                if (queued.has(s)) continue;
+                queued.add(s);
+                heap.push(s);
+            }
+        }
+        markCritical();
+        return changed.map(k => str(model, model.krId[k]));
+    }
+
+    for (const k of order) relax(k);
+    markCritical();
+
+    let byName = null;
+    function indexOf(id) {
+        if (!byName) {
+            byName = new Map();
+            for (let k = n - 1; k >= 0; k--) byName.set(str(model, model.krId[k]), k);
+        }
+        const k = byName.get(String(id));
+        if (k === undefined) throw new DataError(`Unknown KR "${id}"`);
+        return k;
+    }
+
+    return {
+        edges,
+        order,
+        start,
+        end,
+        plannedStart,
+        plannedEnd,
+        duration,
+        critical,
+
+        // Whether KR k takes part in any dependency and has dates to schedule
+        scheduled(k) {
+            return linked(k) && end[k] !== NO_DAY;
+        },
+
+        // KR ids along the critical path, first to last
+        criticalPath() {
+            const path = [];
+            for (const k of order) if (critical[k]) path.push(str(model, model.krId[k]));
+            return path;
+        },
+
+        // Move KR `id`'s end (YYYY-MM-DD or epoch day): it keeps its planned start and
+        // takes until `date`, and everything downstream keeps its duration and moves
+        // with it. The baseline is unchanged, so the slip of each KR is measured
+        // against the source. Returns the ids of the KRs whose projected dates changed.
+        setEnd(id, date) {
+            const k = indexOf(id);
+            const value = typeof date === 'number' ? date : toEpochDay(date);
+            if (value === null) throw new DataError(`Invalid end date "${date}" for ${id}`);
+            if (plannedEnd[k] === NO_DAY) {
+                // Nothing to slip against: this becomes the KR's baseline
+                plannedEnd[k] = value;
+                plan(k);
+            } else {
+                duration[k] = Math.max(0, value - plannedStart[k]);
+            }
+            return propagate([k]);
+        },
+
+        // Make KR `id` depend on `depId`. The order is repaired locally (Pearce-Kelly):
+        // only KRs between the two positions are searched, and a cycle throws before
+        // anything changes. Returns the ids of the KRs whose projected dates changed.
+        addDependency(id, depId) {
+            const k = indexOf(id);
+            const dep = indexOf(depId);
+            if (dep === k) throw new DataError(`${id} depends on itself`);
+            if (preds[k].includes(dep)) return [];
+            const lower = position[k];
+            const upper = position[dep];
+            if (upper > lower) {
+                // Forward from k within the window; reaching dep means a cycle
+                const forward = [];
+                const seen = new Set([k]);
+                const stack = [k];
+                while (stack.length > 0) {
+                    const x = stack.pop();
+                    forward.push(x);
+                    for (const s of succs[x]) {
+                        if (s === dep) throw new DataError(`Dependency cycle: ${depId} → ${id} → ... → ${depId}`);
+                        if (!seen.has(s) && position[s] < upper) {
+                            seen.add(s);
+                            stack.push(s);
+                        }
+                    }
+                }
+                const backward = [];
+                seen.clear();
+                seen.add(dep);
+                stack.push(dep);
+                while (stack.length > 0) {
+                    const x = stack.pop();
+                    backward.push(x);
+                    for (const p of preds[x]) {
+                        if (!seen.has(p) && position[p] > lower) {
+                            seen.add(p);
+                            stack.push(p);
+                        }
+                    }
+                }
+                // dep's ancestors, then k's descendants, into the same positions
+                const byPosition = (a, b) => position[a] - position[b];
+                forward.sort(byPosition);
+                backward.sort(byPosition);
+                const moved = backward.concat(forward);
+                const slots = moved.map(x => position[x]).sort((a, b) => a - b);
+                moved.forEach((x, i) => {
+                    position[x] = slots[i];
+                    order[slots[i]] = x;
+                });
+            }
+            preds[k].push(dep);
+            succs[dep].push(k);
+            this.edges = ++edges;
+            return propagate([k]);
+        },
+
+        // Cache key suffix for objective `o`'s fragments: '' unless some of its KRs are
+        // scheduled through dependencies, so other objectives keep their cache entries
+        signature(o) {
+            const parts = [];
+            for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+                if (linked(k)) parts.push(`${str(model, model.krId[k])}:${start[k]}:${end[k]}:${critical[k]}`);
+            }
+            return parts.length === 0 ? '' : `@${hash(parts.join(','))}`;
+        },
+
+        // { id: { start, end, slip, critical } } for the scheduled KRs
+        toJSON() {
+            const result = {};
+            for (const k of order) {
+                if (!this.scheduled(k)) continue;
+                result[str(model, model.krId[k])] = {
+                    start: day(start[k]) || null,
+                    end: day(end[k]),
+                    slip: end[k] - plannedEnd[k],
+                    critical: critical[k] === 1
+                };
+            }
+            return result;
+        }
+    };
+}
+
+// Graph for a model with any depends_on, else null
+function scheduleOf(model) {
+    return model.krDeps && model.krDeps.length > 0 ? createGraph(model) : null;
+}
+
+module.exports = {
+    createGraph,
+    scheduleOf
+};
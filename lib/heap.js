@@ -0,0 +1,57 @@
+// Binary min-heap ordered by `before(a, b)`, true when a comes out first. Used to
+// replan KRs in topological order (lib/graph.js) and to merge pre-sorted summaries
+// (lib/federate.js).
+class Heap {
+    constructor(before) {
+        this.before = before;
+        this.items = [];
+    }
+
+    push(item) {
+        const { items, before } = this;
+        let i = items.push(item) - 1;
+        while (i > 0) {
+            const parent = (i - 1) >> 1;
+            if (!before(item, items[parent])) break;
+            items[i] = items[parent];
+            i = parent;
+        }
+        items[i] = item;
+    }
+
+    pop() {
+        const { items } = this;
+        const top = items[0];
+        const last = items.pop();
+        if (items.length > 0) this.replaceTop(last);
+        return top;
+    }
+
+    // Put `item` in place of the top and move it down to its place; the same as a pop
+    // and a push, in one pass
+    replaceTop(item) {
+        const { items, before } = this;
+        let i = 0;
+        for (;;) {
+            let child = 2 * i + 1;
+            if (child >= items.length) break;
+            if (child + 1 < items.length && before(items[child + 1], items[child])) child++;
+            if (!before(items[child], item)) break;
+            items[i] = items[child];
+            i = child;
+        }
+        items[i] = item;
+    }
+
+    peek() {
+        return this.items[0];
+    }
+
+    get size() {
+        return this.items.length;
+    }
+}
+
+module.exports = {
+    Heap
+};
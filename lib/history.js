@@ -0,0 +1,166 @@
+const fs = require('fs');
+const path = require('path');
+const io = require('./io');
+const { toEpochDay, DAY_MS } = require('./dates');
+
+// Progress history, one append-only NDJSON chunk per month (2025-07.ndjson), next to
+// okrs.yml. The first line of a chunk is a keyframe with every series' value; each
+// later line holds only what changed since the previous sample, as deltas:
+//   {"t":<ms>,"k":1,"ids":["kr:Q1a",...],"v":[400,...]}     keyframe
+//   {"t":<ms>,"d":[[0,25],...],"n":[["kr:Q5a",0]],"x":[3]}   changed, new, removed
+// Series are referenced by their index in the chunk's id list, which "n" extends.
+// Values are progress percentages stored as integer tenths.
+const HISTORY_DIR = 'okr-history';
+const CHUNK_RE = /^(\d{4}-\d{2})\.ndjson$/;
+
+function monthOf(time) {
+    return new Date(time).toISOString().slice(0, 7);
+}
+
+function chunkPath(dir, month) {
+    return path.join(dir, `${month}.ndjson`);
+}
+
+// Months that have a chunk, oldest first
+function listMonths(dir) {
+    let names;
+    try {
+        names = fs.readdirSync(dir);
+    } catch (error) {
+        return [];
+    }
+    return names.map(name => CHUNK_RE.exec(name)).filter(Boolean).map(match => match[1]).sort();
+}
+
+// Replay a chunk, calling onSample(time, ids, values) after every line, where values[i]
+// is the value in tenths of series ids[i] (undefined once removed). Both arrays are
+// the live state and must be copied if kept.
+function replayChunk(file, onSample = () => {}) {
+    let ids = [];
+    let values = [];
+    let text;
+    try {
+        text = fs.readFileSync(file, 'utf8');
+    } catch (error) {
+        return { ids, values };
+    }
+    for (const line of text.split('\n')) {
+        if (!line) continue;
+        const sample = JSON.parse(line);
+        if (sample.k) {
+            ids = sample.ids.slice();
+            values = sample.v.slice();
+        } else {
+            const { d = [], n = [], x = [] } = sample;
+            for (let j = 0; j < d.length; j++) values[d[j][0]] += d[j][1];
+            for (let j = 0; j < n.length; j++) {
+                ids.push(n[j][0]);
+                values.push(n[j][1]);
+            }
+            for (let j = 0; j < x.length; j++) values[x[j]] = undefined;
+        }
+        onSample(sample.t, ids, values);
+    }
+    return { ids, values };
+}
+
+// Append one run's progress (series id -> percentage) at `time`. Starts the month's
+// chunk with a keyframe; otherwise writes only the series that changed, and nothing
+// at all when no value moved. The line goes through `append(file, chunks)`.
+function appendSample(dir, progress, time = Date.now(), append = io.appendSync) {
+    const file = chunkPath(dir, monthOf(time));
+    const next = new Map();
+    for (const [id, value] of Object.entries(progress)) {
+        if (typeof value === 'number' && isFinite(value)) next.set(id, Math.round(value * 10));
+    }
+    let line;
+    if (!fs.existsSync(file)) {
+        const ids = [...next.keys()];
+        line = { t: time, k: 1, ids, v: ids.map(id => next.get(id)) };
+    } else {
+        const { ids, values } = replayChunk(file);
+        // Removed series that come back are appended again under a new index
+        const index = new Map();
+        ids.forEach((id, i) => {
+            if (values[i] !== undefined) index.set(id, i);
+        });
+        const d = [];
+        const n = [];
+        const x = [];
+        for (const [id, value] of next) {
+            if (!index.has(id)) n.push([id, value]);
+            else if (values[index.get(id)] !== value) d.push([index.get(id), value - values[index.get(id)]]);
+        }
+        for (const [id, i] of index) {
+            if (!next.has(id)) x.push(i);
+        }
+        if (d.length === 0 && n.length === 0 && x.length === 0) return false;
+        line = { t: time };
+        if (d.length > 0) line.d = d;
+        if (n.length > 0) line.n = n;
+        if (x.length > 0) line.x = x;
+    }
+    append(file, [JSON.stringify(line) + '\n']);
+    return true;
+}
+
+function toTime(value, fallback) {
+    if (value === undefined || value === null) return fallback;
+    if (typeof value === 'number') return value;
+    return toEpochDay(value) * DAY_MS;
+}
+
+// Samples between `from` and `to` (ms, Date or YYYY-MM-DD; `to` is inclusive of that
+// whole day when given as a date) for the series in `ids` (all when omitted):
+// { times: [ms...], series: { id: [percent or null, ...] } }, aligned by index.
+// The first point carries the state as of `from`. Only the chunks for months in
+// the range are read, plus the one before it for the starting state.
+function readHistory(dir, { from, to, ids } = {}) {
+    const fromTime = toTime(from, -Infinity);
+    const toTimeValue = to === undefined || typeof to === 'number' ? toTime(to, Infinity) : toTime(to) + DAY_MS - 1;
+    const months = listMonths(dir);
+    const fromMonth = fromTime === -Infinity ? months[0] : monthOf(fromTime);
+    const toMonth = toTimeValue === Infinity ? months[months.length - 1] : monthOf(toTimeValue);
+    let first = months.findIndex(month => month >= fromMonth);
+    if (first === -1) first = months.length;
+    // Values carried into the range come from the last chunk before it
+    const start = Math.max(0, first - 1);
+    const wanted = ids ? new Set(ids) : null;
+    const times = [];
+    const series = {};
+    let before = null;
+
+    const emit = (time, ids, values) => {
+        const row = times.push(time) - 1;
+        for (let i = 0; i < ids.length; i++) {
+            const id = ids[i];
+            if (values[i] === undefined || (wanted && !wanted.has(id))) continue;
+            if (!series[id]) series[id] = new Array(row).fill(null);
+            series[id][row] = values[i] / 10;
+        }
+    };
+    const record = (time, ids, values) => {
+        if (time < fromTime) {
+            before = { ids: ids.slice(), values: values.slice() };
+            return;
+        }
+        if (time > toTimeValue) return;
+        if (before && times.length === 0 && time > fromTime) emit(fromTime, before.ids, before.values);
+        emit(time, ids, values);
+    };
+    for (let i = start; i < months.length && months[i] <= toMonth; i++) replayChunk(chunkPath(dir, months[i]), record);
+    if (before && times.length === 0 && fromTime !== -Infinity) emit(fromTime, before.ids, before.values);
+    // Rows where a series had no value are null
+    for (const id of Object.keys(series)) {
+        const values = series[id];
+        for (let row = 0; row < times.length; row++) if (values[row] === undefined) values[row] = null;
+    }
+    return { times, series };
+}
+
+module.exports = {
+    HISTORY_DIR,
+    listMonths,
+    appendSample,
+    readHistory
+};
@@ -0,0 +1,96 @@
+const fs = require('fs');
+const path = require('path');
+const cache = require('./cache');
+const graph = require('./graph');
+const { NO_DAY } = require('./model');
+const { fromEpochDay } = require('./dates');
+
+// okrs.yml holds the active horizon; finished years or quarters move to their own
+// okrs.yml-shaped files, listed oldest first under this key:
+//   archive: [okrs-2025.yml]
+// Archived files are rendered once and frozen in the cache manifest; later runs only
+// stat them, so the cost of a sync doesn't grow with the archive.
+const ARCHIVE_KEY = 'archive';
+
+// Chart label for a horizon: the suffix of its horizon_<label> key(s), else the years
+// its objectives and KRs end in
+function horizonLabel(data, model) {
+    const keys = Object.keys(data || {}).filter(key => key.startsWith('horizon_')).map(key => key.slice(8)).sort();
+    if (keys.length > 0) return keys.length === 1 ? keys[0] : `${keys[0]}–${keys[keys.length - 1]}`;
+    let first = NO_DAY;
+    let last = NO_DAY;
+    const consider = days => {
+        for (const value of days) {
+            if (value === NO_DAY) continue;
+            if (first === NO_DAY || value < first) first = value;
+            if (last === NO_DAY || value > last) last = value;
+        }
+    };
+    consider(model.objEndDay);
+    consider(model.krEndDay);
+    if (first === NO_DAY) return '';
+    const from = fromEpochDay(first).getUTCFullYear();
+    const to = fromEpochDay(last).getUTCFullYear();
+    return from === to ? String(from) : `${from}–${to}`;
+}
+
+// Archive file names listed in the active okrs.yml
+function archiveFiles(data) {
+    const list = data && data[ARCHIVE_KEY];
+    if (list === undefined || list === null) return [];
+    return (Array.isArray(list) ? list : [list]).map(String);
+}
+
+// Whether every frozen horizon in the manifest is still the file it was rendered from
+function archiveCurrent(entries, baseDir) {
+    if (!entries) return true;
+    return Object.keys(entries).every(file => cache.fileStamp(path.resolve(baseDir, file)) === entries[file].stamp);
+}
+
+// Rendered charts of every archived horizon { file, label, timeline, gantt, legend },
+// in the listed order, and the manifest entries to keep. Only archives whose content
+// changed since they were frozen are parsed and rendered again.
+function archivedHorizons(data, baseDir, previous = {}, options = {}) {
+    const { loadSource, renderCharts, renderObjective } = require('../sync-roadmap');
+    const horizons = [];
+    const entries = {};
+    let rendered = 0;
+    for (const file of archiveFiles(data)) {
+        const fullPath = path.resolve(baseDir, file);
+        const stamp = cache.fileStamp(fullPath);
+        // A listed archive that is missing fails as an I/O error naming the file
+        if (stamp === null) fs.statSync(fullPath);
+        let entry = previous[file];
+        if (!entry || entry.stamp !== stamp) {
+            const contentHash = cache.hashFile(fullPath);
+            if (entry && entry.hash === contentHash) {
+                entry = { ...entry, stamp };
+            } else {
+                const source = loadSource({ yamlPath: fullPath, schema: options.schema });
+                const label = horizonLabel(source.data, source.model);
+                const schedule = graph.scheduleOf(source.model);
+                const charts = renderCharts(source.model, (m, o) => renderObjective(m, o, schedule), label);
+                entry = {
+                    stamp,
+                    hash: contentHash,
+                    label,
+                    timeline: charts.timeline.join(''),
+                    gantt: charts.gantt.join(''),
+                    // Rows only; the archived and active rows share one legend table
+                    legend: charts.legend.slice(1).join('')
+                };
+                rendered++;
+            }
+        }
+        entries[file] = entry;
+        horizons.push({ file, ...entry });
+    }
+    return { horizons, entries, rendered };
+}
+
+module.exports = {
+    ARCHIVE_KEY,
+    horizonLabel,
+    archiveCurrent,
+    archivedHorizons
+};
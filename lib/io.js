@@ -0,0 +1,217 @@
+const fs = require('fs');
+const path = require('path');
+
+const WRITE_BUFFER_SIZE = 64 * 1024;
+
+let tempCounter = 0;
+
+// Temporary file next to `file`, so the final rename stays on one filesystem
+function tempPath(file) {
+    return path.join(path.dirname(file), `.${path.basename(file)}.${process.pid}.${tempCounter++}.tmp`);
+}
+
+// Join small chunks into blocks of about WRITE_BUFFER_SIZE characters instead of
+// building the whole document as one string. Buffer chunks (compressed files) are
+// passed through as they are.
+function* blocks(chunks) {
+    let pending = [];
+    let pendingLength = 0;
+    for (const chunk of chunks) {
+        if (Buffer.isBuffer(chunk)) {
+            if (pending.length > 0) yield pending.join('');
+            pending = [];
+            pendingLength = 0;
+            yield chunk;
+            continue;
+        }
+        pending.push(chunk);
+        pendingLength += chunk.length;
+        if (pendingLength >= WRITE_BUFFER_SIZE) {
+            yield pending.join('');
+            pending = [];
+            pendingLength = 0;
+        }
+    }
+    if (pending.length > 0) yield pending.join('');
+}
+
+// Open `file` for writing, creating its directory on first use (export shards, history)
+function openSync(file, flags) {
+    try {
+        return fs.openSync(file, flags);
+    } catch (error) {
+        if (error.code !== 'ENOENT') throw error;
+        fs.mkdirSync(path.dirname(file), { recursive: true });
+        return fs.openSync(file, flags);
+    }
+}
+
+// Promise-based openSync()
+async function open(file, flags) {
+    try {
+        return await fs.promises.open(file, flags);
+    } catch (error) {
+        if (error.code !== 'ENOENT') throw error;
+        await fs.promises.mkdir(path.dirname(file), { recursive: true });
+        return fs.promises.open(file, flags);
+    }
+}
+
+// Write a chunk list to a temporary file and rename it over `file`, so readers see
+// either the old or the new content, never a partial write
+function writeAtomicSync(file, chunks) {
+    const temp = tempPath(file);
+    try {
+        const fd = openSync(temp, 'w');
+        try {
+            for (const block of blocks(chunks)) fs.writeSync(fd, block);
+        } finally {
+            fs.closeSync(fd);
+        }
+        fs.renameSync(temp, file);
+    } catch (error) {
+        fs.rmSync(temp, { force: true });
+        throw error;
+    }
+}
+
+// Promise-based writeAtomicSync(), leaving the event loop free between blocks
+async function writeAtomic(file, chunks) {
+    const temp = tempPath(file);
+    try {
+        const handle = await open(temp, 'w');
+        try {
+            for (const block of blocks(chunks)) await handle.write(block);
+        } finally {
+            await handle.close();
+        }
+        await fs.promises.rename(temp, file);
+    } catch (error) {
+        await fs.promises.rm(temp, { force: true });
+        throw error;
+    }
+}
+
+// Append a chunk list to `file`, creating it when missing. Not atomic: only for
+// append-only files such as the progress history.
+function appendSync(file, chunks) {
+    const fd = openSync(file, 'a');
+    try {
+        for (const block of blocks(chunks)) fs.writeSync(fd, block);
+    } finally {
+        fs.closeSync(fd);
+    }
+}
+
+// Promise-based appendSync()
+async function append(file, chunks) {
+    const handle = await open(file, 'a');
+    try {
+        for (const block of blocks(chunks)) await handle.write(block);
+    } finally {
+        await handle.close();
+    }
+}
+
+function removeSync(file) {
+    fs.rmSync(file, { force: true });
+}
+
+async function remove(file) {
+    await fs.promises.rm(file, { force: true });
+}
+
+// Whether the file open as `fd` still holds exactly `expected` (a Buffer). Compared
+// block by block, so a same-size edit made since the file was read is caught too.
+function holdsSync(fd, expected) {
+    if (fs.fstatSync(fd).size !== expected.length) return false;
+    const buffer = Buffer.alloc(Math.min(WRITE_BUFFER_SIZE, expected.length));
+    for (let at = 0; at < expected.length;) {
+        const bytes = fs.readSync(fd, buffer, 0, Math.min(buffer.length, expected.length - at), at);
+        if (bytes === 0 || !buffer.subarray(0, bytes).equals(expected.subarray(at, at + bytes))) return false;
+        at += bytes;
+    }
+    return true;
+}
+
+// Promise-based holdsSync() over a FileHandle
+async function holds(handle, expected) {
+    if ((await handle.stat()).size !== expected.length) return false;
+    const buffer = Buffer.alloc(Math.min(WRITE_BUFFER_SIZE, expected.length));
+    for (let at = 0; at < expected.length;) {
+        const { bytesRead } = await handle.read(buffer, 0, Math.min(buffer.length, expected.length - at), at);
+        if (bytesRead === 0 || !buffer.subarray(0, bytesRead).equals(expected.subarray(at, at + bytesRead))) return false;
+        at += bytesRead;
+    }
+    return true;
+}
+
+// Write `plan` ({ writes: [{ at, data }], length }, see sections.patchPlan()) into `file`
+// in place, truncating it to `length` unless that is null. Returns the bytes written,
+// or -1 without touching the file when its content is no longer `original`.
+function patchSync(file, plan, original) {
+    const fd = fs.openSync(file, 'r+');
+    try {
+        if (!holdsSync(fd, Buffer.from(original))) return -1;
+        let written = 0;
+        for (const { at, data } of plan.writes) written += fs.writeSync(fd, data, 0, data.length, at);
+        if (plan.length !== null) fs.ftruncateSync(fd, plan.length);
+        return written;
+    } finally {
+        fs.closeSync(fd);
+    }
+}
+
+// Promise-based patchSync()
+async function patch(file, plan, original) {
+    const handle = await fs.promises.open(file, 'r+');
+    try {
+        if (!(await holds(handle, Buffer.from(original)))) return -1;
+        let written = 0;
+        for (const { at, data } of plan.writes) written += (await handle.write(data, 0, data.length, at)).bytesWritten;
+        if (plan.length !== null) await handle.truncate(plan.length);
+        return written;
+    } finally {
+        await handle.close();
+    }
+}
+
+// Collects writes, appends, removals and in-place patches during a synchronous render
+// and performs them afterwards with non-blocking I/O, in the order they were queued
+// (the cache manifest comes last, after the files it describes). A patch whose file
+// changed since it was read falls back to writing `chunks` atomically.
+function deferredWriter() {
+    const queue = [];
+    return {
+        write(file, chunks) {
+            queue.push(() => writeAtomic(file, chunks));
+        },
+        append(file, chunks) {
+            queue.push(() => append(file, chunks));
+        },
+        remove(file) {
+            queue.push(() => remove(file));
+        },
+        patch(file, plan, original, chunks) {
+            queue.push(async () => {
+                if (await patch(file, plan, original) === -1) await writeAtomic(file, chunks);
+            });
+        },
+        async flush() {
+            for (const task of queue.splice(0)) await task();
+        }
+    };
+}
+
+module.exports = {
+    WRITE_BUFFER_SIZE,
+    writeAtomicSync,
+    writeAtomic,
+    appendSync,
+    append,
+    removeSync,
+    remove,
+    patchSync,
+    patch,
+    deferredWriter
+};
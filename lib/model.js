@@ -0,0 +1,187 @@
+const { hash } = require('./cache');
+const { toEpochDay, formatDay } = require('./dates');
+
+// Sentinels for missing values in the typed columns
+const NO_DAY = -0x80000000;
+const NO_STRING = -1;
+
+// Typed column that grows as rows are appended
+class Column {
+    constructor(Type, capacity = 64) {
+        this.Type = Type;
+        this.data = new Type(capacity);
+        this.length = 0;
+    }
+
+    push(value) {
+        if (this.length === this.data.length) {
+            const next = new this.Type(this.data.length * 2);
+            next.set(this.data);
+            this.data = next;
+        }
+        this.data[this.length++] = value;
+    }
+
+    toArray() {
+        return this.data.slice(0, this.length);
+    }
+}
+
+// Raised for OKR data that parses but can't be used, such as a dependency cycle
+class DataError extends Error {
+    constructor(message) {
+        super(message);
+        this.name = 'DataError';
+    }
+}
+
+function dayOf(value) {
+    const day = toEpochDay(value);
+    return day === null ? NO_DAY : day;
+}
+
+function progressOf(value) {
+    return typeof value === 'number' && isFinite(value) ? value : NaN;
+}
+
+// `depends_on` as a list of KR ids: a list, or one string of ids separated by
+// commas or semicolons (as in a sheet's Depends On column)
+function dependencyIds(value) {
+    if (value === undefined || value === null || value === '') return [];
+    if (Array.isArray(value)) return value.map(String);
+    return String(value).split(/[,;]/).map(id => id.trim()).filter(Boolean);
+}
+
+// Builds the struct-of-arrays OKR model one objective at a time, so it can be fed
+// from a stream. Every string (ids, titles, owners) is interned into one table and
+// the columns hold indexes into it; dates are stored as epoch days.
+class ModelBuilder {
+    constructor() {
+        this.strings = [];
+        this.stringIndex = new Map();
+        this.objHash = [];
+        this.objId = new Column(Int32Array);
+        this.objTitle = new Column(Int32Array);
+        this.objOwner = new Column(Int32Array);
+        this.objStartDay = new Column(Int32Array);
+        this.objEndDay = new Column(Int32Array);
+        this.objKrOffset = new Column(Int32Array);
+        this.krId = new Column(Int32Array, 256);
+        this.krTitle = new Column(Int32Array, 256);
+        this.krOwner = new Column(Int32Array, 256);
+        this.krStartDay = new Column(Int32Array, 256);
+        this.krEndDay = new Column(Int32Array, 256);
+        this.krProgress = new Column(Float64Array, 256);
+        this.krStatus = new Column(Int32Array, 256);
+        this.krPriority = new Column(Int32Array, 256);
+        this.krCategory = new Column(Int32Array, 256);
+        this.krDescription = new Column(Int32Array, 256);
+        this.krObjective = new Column(Int32Array, 256);
+        // depends_on ids (interned) in CSR form: KR k's are krDeps[krDepOffset[k]..krDepOffset[k + 1]]
+        this.krDepOffset = new Column(Int32Array, 256);
+        this.krDeps = new Column(Int32Array);
+    }
+
+    intern(value) {
+        if (value === undefined || value === null) return NO_STRING;
+        const text = String(value);
+        let i = this.stringIndex.get(text);
+        if (i === undefined) {
+            i = this.strings.length;
+            this.strings.push(text);
+            this.stringIndex.set(text, i);
+        }
+        return i;
+    }
+
+    // Append one objective (as loaded from okrs.yml or a CSV sheet) and its KRs;
+    // returns its index. Status, priority, category and description only come from sheets.
+    add(obj) {
+        const o = this.objId.length;
+        const owner = this.intern(obj.owner);
+        this.objHash.push(hash(JSON.stringify(obj)));
+        this.objId.push(this.intern(obj.id));
+        this.objTitle.push(this.intern(obj.title));
+        this.objOwner.push(owner);
+        this.objStartDay.push(dayOf(obj.start));
+        this.objEndDay.push(dayOf(obj.end));
+        this.objKrOffset.push(this.krId.length);
+        for (const kr of obj.krs || []) {
+            this.krId.push(this.intern(kr.id));
+            this.krTitle.push(this.intern(kr.title));
+            this.krOwner.push(kr.owner !== undefined ? this.intern(kr.owner) : owner);
+            this.krStartDay.push(dayOf(kr.start));
+            this.krEndDay.push(dayOf(kr.end));
+            this.krProgress.push(progressOf(kr.progress));
+            this.krStatus.push(this.intern(kr.status));
+            this.krPriority.push(this.intern(kr.priority));
+            this.krCategory.push(this.intern(kr.category !== undefined ? kr.category : obj.category));
+            this.krDescription.push(this.intern(kr.description));
+            this.krObjective.push(o);
+            this.krDepOffset.push(this.krDeps.length);
+            for (const id of dependencyIds(kr.depends_on)) this.krDeps.push(this.intern(id));
+        }
+        return o;
+    }
+
+    build() {
+        const objKrOffset = new Int32Array(this.objKrOffset.length + 1);
+        objKrOffset.set(this.objKrOffset.toArray());
+        objKrOffset[this.objKrOffset.length] = this.krId.length;
+        const krDepOffset = new Int32Array(this.krDepOffset.length + 1);
+        krDepOffset.set(this.krDepOffset.toArray());
+        krDepOffset[this.krDepOffset.length] = this.krDeps.length;
+        return {
+            strings: this.strings,
+            objectiveCount: this.objId.length,
+            krCount: this.krId.length,
+            objHash: this.objHash,
+            objId: this.objId.toArray(),
+            objTitle: this.objTitle.toArray(),
+            objOwner: this.objOwner.toArray(),
+            objStartDay: this.objStartDay.toArray(),
+            objEndDay: this.objEndDay.toArray(),
+            objKrOffset,
+            krId: this.krId.toArray(),
+            krTitle: this.krTitle.toArray(),
+            krOwner: this.krOwner.toArray(),
+            krStartDay: this.krStartDay.toArray(),
+            krEndDay: this.krEndDay.toArray(),
+            krProgress: this.krProgress.toArray(),
+            krStatus: this.krStatus.toArray(),
+            krPriority: this.krPriority.toArray(),
+            krCategory: this.krCategory.toArray(),
+            krDescription: this.krDescription.toArray(),
+            krObjective: this.krObjective.toArray(),
+            krDepOffset,
+            krDeps: this.krDeps.toArray()
+        };
+    }
+}
+
+// Build a model from an iterable of objectives (an array or a stream)
+function buildModel(objectives) {
+    const builder = new ModelBuilder();
+    for (const obj of objectives) builder.add(obj);
+    return builder.build();
+}
+
+// String column value, or '' when missing
+function str(model, index) {
+    return index === NO_STRING ? '' : model.strings[index];
+}
+
+// YYYY-MM-DD for a day column value, or '' when missing
+function day(value) {
+    return value === NO_DAY ? '' : formatDay(value);
+}
+
+module.exports = {
+    NO_DAY,
+    NO_STRING,
+    DataError,
+    ModelBuilder,
+    buildModel,
+    str,
+    day
+};
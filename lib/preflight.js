@@ -0,0 +1,67 @@
+const path = require('path');
+
+// Exit codes, so CI can tell a data problem from a broken install
+const EXIT = {
+    INTERNAL: 1,
+    DEPENDENCY: 2,
+    DATA: 3,
+    DOCUMENT: 4,
+    IO: 5,
+    // --check found ROADMAP.md out of date
+    DRIFT: 6
+};
+
+// Make sure every runtime dependency resolves before anything else is loaded.
+// Never installs anything: a missing module is reported and the process exits.
+function checkDependencies() {
+    const manifest = require(path.join(__dirname, '..', 'package.json'));
+    const missing = Object.keys(manifest.dependencies || {}).filter(name => {
+        try {
+            require.resolve(name);
+            return false;
+        } catch (error) {
+            return true;
+        }
+    });
+    if (missing.length > 0) {
+        console.error(`❌ Missing dependencies: ${missing.join(', ')}. Run \`npm ci\` (or \`npm install\`) first.`);
+        process.exit(EXIT.DEPENDENCY);
+    }
+}
+
+// Map an error thrown by the sync to { kind, exitCode, message }
+function classifyError(error) {
+    if (error && error.name === 'YAMLException') {
+        return { kind: 'data', exitCode: EXIT.DATA, message: `Invalid okrs.yml: ${error.message}` };
+    }
+    if (error && error.name === 'DataError') {
+        return { kind: 'data', exitCode: EXIT.DATA, message: `Invalid OKR data: ${error.message}` };
+    }
+    if (error && error.name === 'SectionError') {
+        return { kind: 'document', exitCode: EXIT.DOCUMENT, message: `Invalid ROADMAP.md: ${error.message}` };
+    }
+    if (error && error.name === 'DependencyError') {
+        return { kind: 'dependency', exitCode: EXIT.DEPENDENCY, message: error.message };
+    }
+    if (error && error.code === 'MODULE_NOT_FOUND') {
+        return { kind: 'dependency', exitCode: EXIT.DEPENDENCY, message: error.message.split('\n')[0] };
+    }
+    if (error && typeof error.code === 'string' && error.syscall) {
+        return { kind: 'io', exitCode: EXIT.IO, message: error.message };
+    }
+    return { kind: 'internal', exitCode: EXIT.INTERNAL, message: (error && error.stack) || String(error) };
+}
+
+// Print a classified diagnostic and set the exit code
+function reportError(error) {
+    const { message, exitCode } = classifyError(error);
+    console.error(`❌ ${message}`);
+    process.exitCode = exitCode;
+}
+
+module.exports = {
+    EXIT,
+    checkDependencies,
+    classifyError,
+    reportError
+};
@@ -0,0 +1,85 @@
+const fs = require('fs');
+const { performance } = require('perf_hooks');
+
+// Written to the working directory by --profile unless a path is given;
+// open it in chrome://tracing or https://ui.perfetto.dev
+const TRACE_FILE = 'roadmap-trace.json';
+
+// Stand-in used when profiling is off: spans just run their function
+const NO_PROFILE = { span: (name, fn) => fn() };
+
+function megabytes(bytes) {
+    return `${bytes >= 0 ? '+' : ''}${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+}
+
+// Records one performance.measure() span and the heap delta per stage. Spans may
+// nest; each is recorded when it ends, with its depth for the summary.
+function createProfiler() {
+    const spans = [];
+    let depth = 0;
+    let sequence = 0;
+
+    function span(name, fn) {
+        const id = `okr:${name}:${sequence++}`;
+        const heapBefore = process.memoryUsage().heapUsed;
+        performance.mark(`${id}:start`);
+        depth++;
+        try {
+            return fn();
+        } finally {
+            depth--;
+            performance.mark(`${id}:end`);
+            const measure = performance.measure(name, `${id}:start`, `${id}:end`);
+            spans.push({
+                name,
+                depth,
+                start: measure.startTime,
+                duration: measure.duration,
+                heapDelta: process.memoryUsage().heapUsed - heapBefore
+            });
+            performance.clearMarks(`${id}:start`);
+            performance.clearMarks(`${id}:end`);
+            performance.clearMeasures(name);
+        }
+    }
+
+    // Chrome trace-event JSON: one complete ("X") event per span, times in microseconds
+    function trace() {
+        const base = { pid: process.pid, tid: 0, cat: 'sync' };
+        return {
+            displayTimeUnit: 'ms',
+            traceEvents: [
+                { ...base, ph: 'M', name: 'process_name', args: { name: 'sync-roadmap' } },
+                ...spans.map(s => ({
+                    ...base,
+                    ph: 'X',
+                    name: s.name,
+                    ts: Math.round(s.start * 1000),
+                    dur: Math.round(s.duration * 1000),
+                    args: { heapDeltaBytes: s.heapDelta }
+                }))
+            ]
+        };
+    }
+
+    // One line with every span in start order: "sync 41.0 ms (+3.2 MB) · read 0.3 ms ..."
+    function summary() {
+        return spans
+            .slice()
+            .sort((a, b) => a.start - b.start || a.depth - b.depth)
+            .map(s => `${s.name} ${s.duration.toFixed(1)} ms (${megabytes(s.heapDelta)})`)
+            .join(' · ');
+    }
+
+    function writeTrace(path) {
+        fs.writeFileSync(path, JSON.stringify(trace()) + '\n');
+    }
+
+    return { span, spans: () => spans, trace, summary, writeTrace };
+}
+
+module.exports = {
+    TRACE_FILE,
+    NO_PROFILE,
+    createProfiler
+};
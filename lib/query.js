@@ -0,0 +1,172 @@
+const cache = require('./cache');
+const { NO_DAY, NO_STRING, str, day } = require('./model');
+const { toEpochDay } = require('./dates');
+
+// Group KR indexes by the string value of one column: value -> Int32Array of KRs
+function hashIndex(model, column) {
+    const groups = new Map();
+    for (let k = 0; k < model.krCount; k++) {
+        const s = column[k];
+        if (s === NO_STRING) continue;
+        const key = model.strings[s];
+        let list = groups.get(key);
+        if (!list) {
+            list = [];
+            groups.set(key, list);
+        }
+        list.push(k);
+    }
+    const index = new Map();
+    for (const [key, list] of groups) index.set(key, Int32Array.from(list));
+    return index;
+}
+
+// KR indexes ordered by end day, with the days alongside for binary search.
+// KRs without an end date are left out.
+function sortedDayIndex(model) {
+    const order = [];
+    for (let k = 0; k < model.krCount; k++) {
+        if (model.krEndDay[k] !== NO_DAY) order.push(k);
+    }
+    const krs = Int32Array.from(order);
+    krs.sort((a, b) => model.krEndDay[a] - model.krEndDay[b] || a - b);
+    const days = new Int32Array(krs.length);
+    for (let i = 0; i < krs.length; i++) days[i] = model.krEndDay[krs[i]];
+    return { krs, days };
+}
+
+// First position whose day is >= `target`
+function lowerBound(days, target) {
+    let lo = 0;
+    let hi = days.length;
+    while (lo < hi) {
+        const mid = (lo + hi) >>> 1;
+        if (days[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Epoch days pass through; Dates and YYYY-MM-DD strings are converted
+function asDay(value) {
+    return typeof value === 'number' ? value : toEpochDay(value);
+}
+
+// First and last epoch day of a quarter written as 2025-Q3
+function quarterRange(quarter) {
+    const match = /^(\d{4})-Q([1-4])$/.exec(quarter);
+    if (!match) throw new Error(`Invalid quarter "${quarter}", expected e.g. 2025-Q3`);
+    const year = Number(match[1]);
+    const month = (Number(match[2]) - 1) * 3;
+    return [toEpochDay(new Date(Date.UTC(year, month, 1))), toEpochDay(new Date(Date.UTC(year, month + 3, 1))) - 1];
+}
+
+const EMPTY = new Int32Array(0);
+
+// Build hash indexes on owner, status and priority plus a sorted end-date index.
+// Equality lookups are O(1) and date ranges O(log n + k); combined queries start
+// from the smallest candidate list and filter it.
+function createIndex(model) {
+    const byOwner = hashIndex(model, model.krOwner);
+    const byStatus = hashIndex(model, model.krStatus);
+    const byPriority = hashIndex(model, model.krPriority);
+    const byEnd = sortedDayIndex(model);
+
+    // KR indexes with end dates in [from, to], both inclusive and optional
+    function dueRange(from, to) {
+        const lo = from === undefined ? 0 : lowerBound(byEnd.days, asDay(from));
+        const hi = to === undefined ? byEnd.days.length : lowerBound(byEnd.days, asDay(to) + 1);
+        return byEnd.krs.subarray(lo, Math.max(lo, hi));
+    }
+
+    // Plain record for one KR
+    function record(k) {
+        const o = model.krObjective[k];
+        const progress = model.krProgress[k];
+        return {
+            id: str(model, model.krId[k]),
+            title: str(model, model.krTitle[k]),
+            objective: str(model, model.objId[o]),
+            owner: str(model, model.krOwner[k]),
+            status: str(model, model.krStatus[k]),
+            priority: str(model, model.krPriority[k]),
+            start: day(model.krStartDay[k]),
+            end: day(model.krEndDay[k]),
+            progress: isNaN(progress) ? null : progress
+        };
+    }
+
+    // All KRs matching every given criterion: { owner, status, priority, dueFrom, dueTo }
+    function find({ owner, status, priority, dueFrom, dueTo } = {}) {
+        const candidates = [];
+        if (owner !== undefined) candidates.push({ list: byOwner.get(owner) || EMPTY, column: model.krOwner, value: owner });
+        if (status !== undefined) candidates.push({ list: byStatus.get(status) || EMPTY, column: model.krStatus, value: status });
+        if (priority !== undefined) candidates.push({ list: byPriority.get(priority) || EMPTY, column: model.krPriority, value: priority });
+        const hasRange = dueFrom !== undefined || dueTo !== undefined;
+        if (hasRange) candidates.push({ list: dueRange(dueFrom, dueTo), range: true });
+        if (candidates.length === 0) {
+            const all = [];
+            for (let k = 0; k < model.krCount; k++) all.push(record(k));
+            return all;
+        }
+
+        candidates.sort((a, b) => a.list.length - b.list.length);
+        const [smallest, ...rest] = candidates;
+        const fromDay = dueFrom === undefined ? -Infinity : asDay(dueFrom);
+        const toDay = dueTo === undefined ? Infinity : asDay(dueTo);
+        const results = [];
+        for (const k of smallest.list) {
+            let ok = true;
+            for (const c of rest) {
+                if (c.range) {
+                    const end = model.krEndDay[k];
+                    ok = end !== NO_DAY && end >= fromDay && end <= toDay;
+                } else {
+                    ok = c.column[k] !== NO_STRING && model.strings[c.column[k]] === c.value;
+                }
+                if (!ok) break;
+            }
+            if (ok) results.push(record(k));
+        }
+        // Date-range queries come back in due-date order; others in file order
+        if (!smallest.range && hasRange) results.sort((a, b) => (a.end < b.end ? -1 : a.end > b.end ? 1 : 0));
+        return results;
+    }
+
+    return {
+        model,
+        find,
+        byOwner: owner => find({ owner }),
+        byStatus: status => find({ status }),
+        byPriority: priority => find({ priority }),
+        dueBetween: (from, to) => find({ dueFrom: from, dueTo: to }),
+        dueInQuarter: quarter => {
+            const [from, to] = quarterRange(quarter);
+            return find({ dueFrom: from, dueTo: to });
+        },
+        // KRs due within the next `days` days, counting from `today` (inclusive)
+        dueWithin: (days, today = toEpochDay(new Date())) => find({ dueFrom: asDay(today), dueTo: asDay(today) + days }),
+        owners: () => [...byOwner.keys()],
+        statuses: () => [...byStatus.keys()],
+        priorities: () => [...byPriority.keys()]
+    };
+}
+
+// Indexes kept per source file and rebuilt only when its size or mtime changes,
+// so a lookup per HTTP request costs one stat call
+const indexCache = new Map();
+
+function openIndex(sourcePath, loadModel) {
+    const signature = cache.fileStamp(sourcePath);
+    const cached = indexCache.get(sourcePath);
+    if (cached && cached.signature === signature) return cached.index;
+    const index = createIndex(loadModel());
+    indexCache.set(sourcePath, { signature, index });
+    return index;
+}
+
+module.exports = {
+    quarterRange,
+    createIndex,
+    openIndex
+};
@@ -0,0 +1,123 @@
+const { NO_DAY, NO_STRING, str } = require('./model');
+const { formatDay, quarterOf } = require('./dates');
+
+// Written next to ROADMAP.md; the statistics dashboard reads its `overall` block as is
+const STATS_FILE = 'roadmap-stats.json';
+const STATS_VERSION = 1;
+
+function emptyTotals() {
+    return { keyResults: 0, measured: 0, progressSum: 0, completed: 0, due: 0 };
+}
+
+function addTotals(into, from) {
+    into.keyResults += from.keyResults;
+    into.measured += from.measured;
+    into.progressSum += from.progressSum;
+    into.completed += from.completed;
+    into.due += from.due;
+    return into;
+}
+
+// Progress of KR `k` as of `today` (0-100): the Progress column when present,
+// otherwise the share of its start..end span that has elapsed. KRs start where the
+// Gantt bars do (own start, objective start, else the start of their end quarter).
+// Returns NaN when there is no end date to estimate from.
+function krProgress(model, k, today) {
+    const explicit = model.krProgress[k];
+    if (!isNaN(explicit)) return explicit;
+    const o = model.krObjective[k];
+    const end = model.krEndDay[k] !== NO_DAY ? model.krEndDay[k] : model.objEndDay[o];
+    if (end === NO_DAY) return NaN;
+    let start = model.krStartDay[k] !== NO_DAY ? model.krStartDay[k] : model.objStartDay[o];
+    if (start === NO_DAY) start = quarterOf(end).start;
+    if (today >= end) return 100;
+    if (today <= start) return 0;
+    return ((today - start) / (end - start)) * 100;
+}
+
+// Additive partial sums for objective `o` as of `today`, overall and per quarter of
+// the KRs' end dates. This is the unit cached between runs: totals for the whole
+// roadmap are sums of these, so one changed KR only recomputes its own objective.
+function objectiveRollup(model, o, today) {
+    const totals = emptyTotals();
+    const quarters = {};
+    for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+        const progress = krProgress(model, k, today);
+        const end = model.krEndDay[k] !== NO_DAY ? model.krEndDay[k] : model.objEndDay[o];
+        const status = model.krStatus[k];
+        const kr = emptyTotals();
+        kr.keyResults = 1;
+        if (!isNaN(progress)) {
+            kr.measured = 1;
+            kr.progressSum = progress;
+        }
+        if ((status !== NO_STRING && model.strings[status] === 'Completed') || progress >= 100) kr.completed = 1;
+        if (end !== NO_DAY && end <= today) kr.due = 1;
+        addTotals(totals, kr);
+        if (end !== NO_DAY) {
+            const label = quarterOf(end).label;
+            addTotals(quarters[label] || (quarters[label] = emptyTotals()), kr);
+        }
+    }
+    const end = model.objEndDay[o];
+    return {
+        id: str(model, model.objId[o]),
+        title: str(model, model.objTitle[o]),
+        active: end === NO_DAY || end >= today,
+        totals,
+        quarters
+    };
+}
+
+function round(value) {
+    return Math.round(value * 10) / 10;
+}
+
+// Public shape of a totals block: counts plus the KR-weighted average progress
+function summarize(totals) {
+    return {
+        keyResults: totals.keyResults,
+        completed: totals.completed,
+        due: totals.due,
+        progress: totals.measured > 0 ? round(totals.progressSum / totals.measured) : null
+    };
+}
+
+// Merge per-objective rollups into the stats document
+function combineRollups(rollups, today) {
+    const overall = emptyTotals();
+    const quarters = {};
+    let active = 0;
+    for (const rollup of rollups) {
+        addTotals(overall, rollup.totals);
+        if (rollup.active) active++;
+        for (const label of Object.keys(rollup.quarters)) {
+            addTotals(quarters[label] || (quarters[label] = emptyTotals()), rollup.quarters[label]);
+        }
+    }
+    const byQuarter = {};
+    for (const label of Object.keys(quarters).sort()) byQuarter[label] = summarize(quarters[label]);
+    return {
+        version: STATS_VERSION,
+        asOf: formatDay(today),
+        overall: { objectives: rollups.length, activeObjectives: active, ...summarize(overall) },
+        objectives: rollups.map(rollup => ({ id: rollup.id, title: rollup.title, ...summarize(rollup.totals) })),
+        quarters: byQuarter
+    };
+}
+
+// On-disk form of the stats document
+function serializeStats(stats) {
+    return JSON.stringify(stats, null, 2) + '\n';
+}
+
+module.exports = {
+    STATS_FILE,
+    emptyTotals,
+    addTotals,
+    summarize,
+    krProgress,
+    objectiveRollup,
+    combineRollups,
+    serializeStats
+};
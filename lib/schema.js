@@ -0,0 +1,169 @@
+const yaml = require('js-yaml');
+
+// Plain YYYY-MM-DD dates only. Replaces js-yaml's full timestamp resolver, whose
+// regexes (times, fractions, offsets) otherwise run on every plain scalar.
+const DATE_RE = /^\d{4}-\d{2}-\d{2}$/;
+
+// Whether a year, month and day name a real day. Date.UTC() rolls impossible ones
+// over (2025-02-30 becomes March 2), so the fields have to survive the round trip.
+function isCalendarDay(year, month, day) {
+    const date = new Date(Date.UTC(year, month - 1, day));
+    return date.getUTCFullYear() === year && date.getUTCMonth() === month - 1 && date.getUTCDate() === day;
+}
+
+// A YYYY-MM-DD string naming a real day
+function isDateString(value) {
+    return typeof value === 'string' && DATE_RE.test(value) &&
+        isCalendarDay(+value.slice(0, 4), +value.slice(5, 7), +value.slice(8, 10));
+}
+
+const okrDate = new yaml.Type('tag:yaml.org,2002:timestamp', {
+    kind: 'scalar',
+    resolve: data => data !== null && data.length === 10 && isDateString(data),
+    construct: data => new Date(Date.UTC(+data.slice(0, 4), +data.slice(5, 7) - 1, +data.slice(8, 10))),
+    instanceOf: Date,
+    represent: date => date.toISOString().slice(0, 10)
+});
+
+// CORE_SCHEMA (strings, numbers, booleans, null) plus dates: no merge keys,
+// binary, sets, omaps or pairs
+const OKR_SCHEMA = yaml.CORE_SCHEMA.extend({ implicit: [okrDate] });
+
+// js-yaml's timestamps, except that an impossible day loads as an invalid Date, which
+// the validator reports, instead of rolling over into the next month
+const timestamp = yaml.types.timestamp;
+const TIMESTAMP_DAY = /^(\d{4})-(\d\d?)-(\d\d?)/;
+const checkedTimestamp = new yaml.Type('tag:yaml.org,2002:timestamp', {
+    kind: 'scalar',
+    resolve: timestamp.resolve,
+    construct: data => {
+        const [, year, month, day] = TIMESTAMP_DAY.exec(data);
+        return isCalendarDay(+year, +month, +day) ? timestamp.construct(data) : new Date(NaN);
+    },
+    instanceOf: Date,
+    represent: timestamp.represent
+});
+
+// js-yaml's DEFAULT_SCHEMA with checked timestamps, for okrs.yml without --okr-schema
+const DEFAULT_SCHEMA = yaml.DEFAULT_SCHEMA.extend({ implicit: [checkedTimestamp] });
+
+function describe(value) {
+    if (value === null) return 'null';
+    if (value instanceof Date) return isNaN(value.getTime()) ? 'invalid date' : 'date';
+    if (Array.isArray(value)) return 'list';
+    if (typeof value === 'number') return `number ${value}`;
+    if (typeof value === 'string') return `string "${value.length > 40 ? `${value.slice(0, 40)}...` : value}"`;
+    return typeof value;
+}
+
+function mismatch(where, expected, value) {
+    return `${where}: expected ${expected}, got ${describe(value)}`;
+}
+
+// Path of `key` under `where`, built only when there is a problem to report
+function at(where, key) {
+    return where ? `${where}.${key}` : key;
+}
+
+function checkString(owner, key, where, required, report) {
+    const value = owner[key];
+    if (value === undefined && !required) return;
+    if (typeof value !== 'string' && typeof value !== 'number') report(mismatch(at(where, key), 'a string', value));
+}
+
+function checkDate(owner, key, where, report) {
+    const value = owner[key];
+    if (value === undefined) return;
+    if (value instanceof Date) {
+        if (isNaN(value.getTime())) report(mismatch(at(where, key), 'a valid date', value));
+        return;
+    }
+    if (!isDateString(value)) {
+        report(mismatch(at(where, key), 'a YYYY-MM-DD date', value));
+    }
+}
+
+function checkProgress(owner, key, where, report) {
+    const value = owner[key];
+    if (value === undefined) return;
+    if (typeof value !== 'number' || !(value >= 0 && value <= 100)) report(mismatch(at(where, key), 'a number from 0 to 100', value));
+}
+
+// A string or a list of strings (KR ids, archive file names)
+function checkStrings(owner, key, where, report) {
+    const value = owner[key];
+    if (value === undefined || value === null) return;
+    if (Array.isArray(value)) {
+        for (let i = 0; i < value.length; i++) checkString(value, i, at(where, key), true, report);
+        return;
+    }
+    checkString(owner, key, where, true, report);
+}
+
+function isMapping(value) {
+    return Boolean(value) && typeof value === 'object' && !Array.isArray(value) && !(value instanceof Date);
+}
+
+// Type-check one objective as it comes out of the loader, passing every problem to
+// `report` (see lib/validate.js)
+function checkObjective(obj, where, report) {
+    if (!isMapping(obj)) {
+        report(mismatch(where, 'a mapping', obj));
+        return obj;
+    }
+    checkString(obj, 'id', where, true, report);
+    checkString(obj, 'title', where, true, report);
+    checkString(obj, 'owner', where, false, report);
+    checkDate(obj, 'start', where, report);
+    checkDate(obj, 'end', where, report);
+    if (obj.krs === undefined || obj.krs === null) return obj;
+    if (!Array.isArray(obj.krs)) {
+        report(mismatch(at(where, 'krs'), 'a list', obj.krs));
+        return obj;
+    }
+    for (let i = 0; i < obj.krs.length; i++) {
+        const kr = obj.krs[i];
+        const krWhere = `${where}.krs[${i}]`;
+        if (!isMapping(kr)) {
+            report(mismatch(krWhere, 'a mapping', kr));
+            continue;
+        }
+        checkString(kr, 'id', krWhere, true, report);
+        checkString(kr, 'title', krWhere, true, report);
+        checkString(kr, 'owner', krWhere, false, report);
+        checkDate(kr, 'start', krWhere, report);
+        checkDate(kr, 'end', krWhere, report);
+        checkProgress(kr, 'progress', krWhere, report);
+        checkStrings(kr, 'depends_on', krWhere, report);
+    }
+    return obj;
+}
+
+// Type-check the top-level keys other than objectives
+function checkHeader(data, report) {
+    if (!isMapping(data)) {
+        report(mismatch('okrs.yml', 'a mapping', data));
+        return data;
+    }
+    if (data.objectives !== undefined && data.objectives !== null && !Array.isArray(data.objectives)) {
+        report(mismatch('objectives', 'a list', data.objectives));
+    }
+    checkString(data, 'north_star', '', false, report);
+    // Name of this installation in an org-wide roadmap (see lib/federate.js)
+    checkString(data, 'installation', '', false, report);
+    for (const key of Object.keys(data)) {
+        if (key.startsWith('horizon_')) checkDate(data, key, '', report);
+    }
+    // Archived horizon files: one name or a list
+    checkStrings(data, 'archive', '', report);
+    return data;
+}
+
+module.exports = {
+    OKR_SCHEMA,
+    DEFAULT_SCHEMA,
+    isDateString,
+    isMapping,
+    checkObjective,
+    checkHeader
+};
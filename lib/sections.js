@@ -0,0 +1,222 @@
+const fs = require('fs');
+const { writeAtomicSync, patchSync } = require('./io');
+
+// Generated regions in ROADMAP.md are delimited by HTML comments:
+//   <!-- okr:<name>:start --> ... <!-- okr:<name>:end -->
+// Everything outside a region is hand-written Markdown and is never touched.
+const MARKER_RE = /<!-- okr:([\w-]+):(start|end) -->/g;
+
+// Raised for malformed or missing markers, as opposed to I/O failures
+class SectionError extends Error {
+    constructor(message) {
+        super(message);
+        this.name = 'SectionError';
+    }
+}
+
+function startMarker(name) {
+    return `<!-- okr:${name}:start -->`;
+}
+
+function endMarker(name) {
+    return `<!-- okr:${name}:end -->`;
+}
+
+// Empty region, ready to be filled by the next splice
+function emptyRegion(name) {
+    return `${startMarker(name)}\n${endMarker(name)}`;
+}
+
+// Split the document into literal text and named regions in a single scan.
+// Literal parts keep the markers, so joining every part's text gives back the input.
+function tokenize(doc) {
+    const parts = [];
+    let last = 0;
+    let open = null;
+    MARKER_RE.lastIndex = 0;
+    let m;
+    while ((m = MARKER_RE.exec(doc)) !== null) {
+        const [marker, name, kind] = m;
+        if (kind === 'start') {
+            if (open) throw new SectionError(`Section "${name}" starts inside unclosed section "${open.name}"`);
+            open = { name, bodyStart: m.index + marker.length };
+            parts.push({ text: doc.slice(last, open.bodyStart) });
+        } else {
+            if (!open || open.name !== name) throw new SectionError(`Unmatched end marker for section "${name}"`);
+            parts.push({ name, text: doc.slice(open.bodyStart, m.index) });
+            last = m.index;
+            open = null;
+        }
+    }
+    if (open) throw new SectionError(`Section "${open.name}" is missing its end marker`);
+    parts.push({ text: doc.slice(last) });
+    return parts;
+}
+
+// Names of all regions present in a tokenized document
+function sectionNames(parts) {
+    return parts.filter(p => p.name).map(p => p.name);
+}
+
+// True when the chunks of `body` concatenate to exactly `text`, without joining them
+function bodyEquals(body, text) {
+    if (typeof body === 'string') return body === text;
+    let offset = 0;
+    for (const chunk of body) {
+        if (!text.startsWith(chunk, offset)) return false;
+        offset += chunk.length;
+    }
+    return offset === text.length;
+}
+
+// Swap in new bodies for the regions named in `sections` (name -> body, where a
+// body is a string or an array of chunks). Regions whose body is unchanged are
+// left as-is; unknown names are ignored. Returns the document as a chunk list, and
+// as segments { text, body } per part where body is null for the parts kept as-is.
+function splice(parts, sections) {
+    const changed = [];
+    const chunks = [];
+    const segments = [];
+    for (const part of parts) {
+        const body = part.name !== undefined ? sections[part.name] : undefined;
+        if (body !== undefined && !bodyEquals(body, part.text)) {
+            changed.push(part.name);
+            if (typeof body === 'string') chunks.push(body);
+            else for (const chunk of body) chunks.push(chunk);
+            segments.push({ text: part.text, body });
+        } else {
+            chunks.push(part.text);
+            segments.push({ text: part.text, body: null });
+        }
+    }
+    return { chunks, changed, segments };
+}
+
+// Write a chunk list in buffered blocks via a temporary file and a rename, so
+// readers never see a half-written document
+function writeChunks(path, chunks) {
+    writeAtomicSync(path, chunks);
+}
+
+// Byte writes that turn the document splice() `segments` came from into the spliced
+// one: { writes: [{ at, data }], length }. When every changed region keeps its byte
+// length only those ranges are overwritten (`length` null); otherwise the file is
+// rewritten from the first changed region on and truncated to `length`.
+function patchPlan(segments) {
+    const ranges = [];
+    let offset = 0;
+    let sameLength = true;
+    for (const segment of segments) {
+        const length = Buffer.byteLength(segment.text);
+        if (segment.body !== null) {
+            const data = Buffer.from(typeof segment.body === 'string' ? segment.body : segment.body.join(''));
+            if (data.length !== length) sameLength = false;
+            ranges.push({ offset, data, segment });
+        }
+        offset += length;
+    }
+    if (sameLength) return { writes: ranges.map(({ offset: at, data }) => ({ at, data })), length: null };
+    const writes = [];
+    let at = ranges[0].offset;
+    const first = segments.indexOf(ranges[0].segment);
+    const bodies = new Map(ranges.map(range => [range.segment, range.data]));
+    for (let i = first; i < segments.length; i++) {
+        const data = bodies.get(segments[i]) || Buffer.from(segments[i].text);
+        writes.push({ at, data });
+        at += data.length;
+    }
+    return { writes, length: at };
+}
+
+// Rewrite only the changed byte ranges of a file whose content is still `original`,
+// given splice() segments (see patchPlan()). Returns the bytes written, or -1 without
+// touching the file when its content is no longer `original`. Unlike writeChunks()
+// this is not atomic, so it is only used when asked for (--diff).
+function patchFile(path, segments, original) {
+    return patchSync(path, patchPlan(segments), original);
+}
+
+// Tokenize, splice and write back, only when something changed.
+// Files missing markers are upgraded in place first; regions listed in `optional`
+// are skipped instead of failing when the document has no place for them.
+// `original` may be passed when the caller has already read the file, `write`
+// replaces the default atomic write, and `span` wraps the splice and write stages.
+// `patch` writes only the changed byte ranges in place (see patchFile()), falling back
+// to `write` when markers were migrated or the file changed since it was read; the
+// patch goes through `writePatch(path, plan, original, chunks)` when given, which must
+// fall back to writing `chunks` itself.
+function updateFile(path, sections, original = fs.readFileSync(path, 'utf8'), {
+    optional = [],
+    write = writeChunks,
+    patch = false,
+    writePatch = null,
+    span = (name, fn) => fn()
+} = {}) {
+    const { migrated, result } = span('splice', () => {
+        let parts = tokenize(original);
+        const upgraded = addLegacyMarkers(original, new Set(sectionNames(parts)));
+        const changedMarkers = upgraded !== original;
+        if (changedMarkers) parts = tokenize(upgraded);
+        const present = new Set(sectionNames(parts));
+        const missing = Object.keys(sections).filter(name => !present.has(name) && !optional.includes(name));
+        if (missing.length > 0) {
+            throw new SectionError(`${path} has no marker for section(s): ${missing.join(', ')}`);
+        }
+        return { migrated: changedMarkers, result: splice(parts, sections) };
+    });
+    if (migrated || result.changed.length > 0) {
+        span('write', () => {
+            if (!patch || migrated) write(path, result.chunks);
+            else if (writePatch) writePatch(path, patchPlan(result.segments), original, result.chunks);
+            else if (patchFile(path, result.segments, original) === -1) write(path, result.chunks);
+        });
+    }
+    return result;
+}
+
+// One-time upgrades for roadmaps written before a group of regions had markers.
+// Each one runs only when none of its regions are present yet.
+const LEGACY_UPGRADES = [
+    {
+        names: ['north-star'],
+        apply: doc => doc.replace(/^> \*\*North Star\*\*: .*$/m,
+            line => `${startMarker('north-star')}\n${line}\n${endMarker('north-star')}`)
+    },
+    {
+        // Drops the old generated timeline block and leaves empty regions in its place
+        names: ['timeline', 'legend'],
+        apply: doc => doc
+            .replace(/\n## 🕒 Timeline Overview\n[\s\S]*?#### 🗂️ Timeline Legend\n\n(?:\|.*\|\n)*/, '\n')
+            .replace(/(## 📅 2025 Roadmap Overview[\s\S]*?\n---\n)/,
+                `$1\n## 🕒 Timeline Overview\n\n${emptyRegion('timeline')}\n\n#### 🗂️ Timeline Legend\n\n${emptyRegion('legend')}\n`)
+    },
+    {
+        // Replaces whatever is left under the Gantt heading, up to the next rule
+        names: ['gantt', 'gantt-legend'],
+        apply: doc => doc.replace(/(## 📊 Gantt Chart Overview\n)[\s\S]*?(\n---\n)/,
+            `$1\n${emptyRegion('gantt')}\n\n#### 🗂️ Gantt Chart Legend\n\n${emptyRegion('gantt-legend')}\n\n$2`)
+    }
+];
+
+function addLegacyMarkers(doc, present = new Set()) {
+    for (const upgrade of LEGACY_UPGRADES) {
+        if (!upgrade.names.some(name => present.has(name))) doc = upgrade.apply(doc);
+    }
+    return doc;
+}
+
+module.exports = {
+    SectionError,
+    startMarker,
+    endMarker,
+    emptyRegion,
+    tokenize,
+    sectionNames,
+    bodyEquals,
+    splice,
+    writeChunks,
+    patchPlan,
+    patchFile,
+    updateFile,
+    addLegacyMarkers
+};
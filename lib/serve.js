@@ -0,0 +1,221 @@
+const fs = require('fs');
+const http = require('http');
+const path = require('path');
+const zlib = require('zlib');
+const crypto = require('crypto');
+const { NO_STRING, str, day } = require('./model');
+const { toEpochDay } = require('./dates');
+const cache = require('./cache');
+const rollups = require('./rollups');
+const viewer = require('./viewer');
+const { horizonLabel } = require('./horizons');
+
+const DEFAULT_PORT = 4000;
+const DEBOUNCE_MS = 30;
+
+// Everything served is precomputed here once per change: the body, its strong ETag and
+// its brotli and gzip encodings. Requests only pick a variant.
+function representation(type, body) {
+    const identity = Buffer.from(body);
+    const tag = crypto.createHash('sha1').update(identity).digest('hex');
+    const variant = (encoding, data) => ({ encoding, data, etag: `"${tag}${encoding ? `-${encoding}` : ''}"` });
+    return {
+        type,
+        variants: {
+            br: variant('br', zlib.brotliCompressSync(identity, {
+                params: { [zlib.constants.BROTLI_PARAM_SIZE_HINT]: identity.length }
+            })),
+            gzip: variant('gzip', zlib.gzipSync(identity, { level: 9 })),
+            identity: variant(null, identity)
+        }
+    };
+}
+
+// Objectives and KRs as plain JSON, straight from the model
+function okrsJson(model, data) {
+    const objectives = [];
+    for (let o = 0; o < model.objectiveCount; o++) {
+        const krs = [];
+        for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+            const progress = model.krProgress[k];
+            krs.push({
+                id: str(model, model.krId[k]),
+                title: str(model, model.krTitle[k]),
+                owner: str(model, model.krOwner[k]) || null,
+                status: model.krStatus[k] === NO_STRING ? null : str(model, model.krStatus[k]),
+                start: day(model.krStartDay[k]) || null,
+                end: day(model.krEndDay[k]) || null,
+                progress: isNaN(progress) ? null : progress
+            });
+        }
+        objectives.push({
+            id: str(model, model.objId[o]),
+            title: str(model, model.objTitle[o]),
+            owner: str(model, model.objOwner[o]) || null,
+            start: day(model.objStartDay[o]) || null,
+            end: day(model.objEndDay[o]) || null,
+            krs
+        });
+    }
+    const northStar = data && data.north_star ? String(data.north_star).trim() : null;
+    return JSON.stringify({ northStar, objectives }) + '\n';
+}
+
+// All precomputed responses for the current roadmap, by URL path
+function buildRepresentations(model, data, documentText, manifest, { shard = 'objective' } = {}) {
+    const { renderObjective } = require('../sync-roadmap');
+    const cached = (manifest && manifest.objectives) || {};
+    const render = (m, o) => cached[m.objHash[o]] || renderObjective(m, o);
+    const today = toEpochDay(new Date());
+    const perObjective = [];
+    for (let o = 0; o < model.objectiveCount; o++) perObjective.push(rollups.objectiveRollup(model, o, today));
+    const markdown = representation('text/markdown; charset=utf-8', documentText);
+    return new Map([
+        ['/', markdown],
+        ['/roadmap.md', markdown],
+        ['/roadmap.html', representation('text/html; charset=utf-8', viewer.viewerChunks(model, render, shard, `KairOS ${horizonLabel(data, model)} Roadmap`).join(''))],
+        ['/okrs.json', representation('application/json; charset=utf-8', okrsJson(model, data))],
+        ['/stats.json', representation('application/json; charset=utf-8', rollups.serializeStats(rollups.combineRollups(perObjective, today)))]
+    ]);
+}
+
+// Preferred encoding the client accepts: br, then gzip, then none
+function negotiate(acceptEncoding = '') {
+    const accepted = new Set();
+    for (const part of acceptEncoding.split(',')) {
+        const [name, ...params] = part.trim().toLowerCase().split(';');
+        if (params.some(param => /^\s*q=0(\.0*)?\s*$/.test(param))) continue;
+        accepted.add(name);
+    }
+    if (accepted.has('br')) return 'br';
+    if (accepted.has('gzip') || accepted.has('*')) return 'gzip';
+    return 'identity';
+}
+
+function matches(ifNoneMatch, etag) {
+    if (!ifNoneMatch) return false;
+    return ifNoneMatch.split(',').some(tag => {
+        const value = tag.trim();
+        return value === '*' || value === etag;
+    });
+}
+
+// Serve okrs.yml (or a CSV sheet) with the sync kept warm in memory. Sources and
+// ROADMAP.md are watched; after a change the sync runs once (debounced) and every
+// representation is rebuilt, so requests never touch the disk or re-render.
+function createRoadmapServer(options = {}, { debounceMs = DEBOUNCE_MS, onSync = () => {}, onError = () => {} } = {}) {
+    const { syncRoadmap, CACHE_FILE } = require('../sync-roadmap');
+    const sourcePath = path.resolve(options.csvPath || options.yamlPath || 'okrs.yml');
+    const mdPath = path.resolve(options.mdPath || 'ROADMAP.md');
+    // Start from the saved fragments but without the source hash, so the first sync
+    // parses the source and leaves the model in `state`
+    const cachePath = options.cachePath || path.join(path.dirname(sourcePath), CACHE_FILE);
+    const state = { manifest: { ...cache.loadManifest(cachePath), source: null } };
+    let representations = null;
+    let builtFrom = { model: null, document: null };
+    let timer = null;
+    let running = null;
+    let again = false;
+
+    async function refresh() {
+        const result = await syncRoadmap({ ...options, state });
+        // Syncs that changed nothing (including the one our own write triggers) keep the
+        // current responses
+        const documentText = state.document.join('');
+        if (representations && state.model === builtFrom.model && documentText === builtFrom.document) return result;
+        representations = buildRepresentations(state.model, state.data, documentText, state.manifest, options);
+        builtFrom = { model: state.model, document: documentText };
+        return result;
+    }
+
+    // Serialized: a change during a refresh schedules exactly one more
+    function schedule() {
+        if (running) {
+            again = true;
+            return running;
+        }
+        running = refresh()
+            .then(result => onSync(result), onError)
+            .finally(() => {
+                running = null;
+                if (again) {
+                    again = false;
+                    schedule();
+                }
+            });
+        return running;
+    }
+
+    const watched = new Set([sourcePath, mdPath]);
+    const watchers = [...new Set([path.dirname(sourcePath), path.dirname(mdPath)])].map(dir =>
+        fs.watch(dir, (event, filename) => {
+            if (filename && !watched.has(path.join(dir, filename))) return;
+            if (timer) clearTimeout(timer);
+            timer = setTimeout(() => {
+                timer = null;
+                schedule();
+            }, debounceMs);
+        }));
+
+    const server = http.createServer((req, res) => {
+        const url = new URL(req.url, 'http://localhost');
+        if (req.method !== 'GET' && req.method !== 'HEAD') {
+            res.writeHead(405, { Allow: 'GET, HEAD' });
+            res.end();
+            return;
+        }
+        if (!representations) {
+            res.writeHead(503, { 'Retry-After': '1' });
+            res.end('Roadmap not ready\n');
+            return;
+        }
+        const entry = representations.get(url.pathname);
+        if (!entry) {
+            res.writeHead(404, { 'Content-Type': 'text/plain; charset=utf-8' });
+            res.end(`Not found. Try ${[...representations.keys()].join(', ')}\n`);
+            return;
+        }
+        const variant = entry.variants[negotiate(req.headers['accept-encoding'])];
+        const headers = { ETag: variant.etag, Vary: 'Accept-Encoding', 'Cache-Control': 'no-cache' };
+        if (matches(req.headers['if-none-match'], variant.etag)) {
+            res.writeHead(304, headers);
+            res.end();
+            return;
+        }
+        headers['Content-Type'] = entry.type;
+        headers['Content-Length'] = variant.data.length;
+        if (variant.encoding) headers['Content-Encoding'] = variant.encoding;
+        res.writeHead(200, headers);
+        res.end(req.method === 'HEAD' ? undefined : variant.data);
+    });
+
+    const ready = schedule();
+    server.on('close', () => {
+        if (timer) clearTimeout(timer);
+        for (const watcher of watchers) watcher.close();
+    });
+    return { server, ready, refresh: schedule };
+}
+
+// CLI: node sync-roadmap.js --serve [--port N] [--host H] [sync flags]
+function main(args) {
+    const { describeResult, parseSyncFlags } = require('../sync-roadmap');
+    const { classifyError } = require('./preflight');
+    const options = parseSyncFlags(args);
+    const portIndex = args.indexOf('--port');
+    const hostIndex = args.indexOf('--host');
+    const port = Number(portIndex !== -1 ? args[portIndex + 1] : process.env.PORT || DEFAULT_PORT);
+    const host = hostIndex !== -1 ? args[hostIndex + 1] : '127.0.0.1';
+    const { server } = createRoadmapServer(options, {
+        onSync: result => console.log(`🔄 Roadmap ${describeResult(result)}`),
+        onError: error => console.error(`❌ ${classifyError(error).message}`)
+    });
+    server.listen(port, host, () => console.log(`🌐 Serving roadmap on http://${host}:${port}/ (Ctrl+C to stop)`));
+}
+
+module.exports = {
+    negotiate,
+    buildRepresentations,
+    createRoadmapServer,
+    main
+};
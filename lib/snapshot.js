@@ -0,0 +1,172 @@
+const fs = require('fs');
+const { DAY_MS } = require('./dates');
+const { writeAtomicSync } = require('./io');
+
+// Compiled form of okrs.yml, written next to it as okrs.snapshot.json and loaded
+// instead of running the YAML parser while its source hash and schema still match.
+//
+// Layout:
+//   schema      the YAML schema the source was parsed with ('default' or 'okr')
+//   strings     interned string table; ids, titles and owners are indexes into it
+//   shapes      key lists in source order, shared by the records that have them
+//   objectives  [shape, id, title, owner, end, krs, extra?] per objective
+//   krs         [shape, id, title, end, extra?] per key result
+//   end         epoch day (number) for midnight-UTC dates, otherwise { raw }
+//   extra       any other keys, with Dates tagged as { $date: iso }
+//   rest        top-level keys besides objectives, tagged the same way
+// Records are decoded with their keys in source order, so an objective hashes the
+// same (model objHash) whether it came from the snapshot or from the YAML.
+const SNAPSHOT_VERSION = 2;
+
+const OBJECTIVE_KEYS = new Set(['id', 'title', 'owner', 'end', 'krs']);
+const KR_KEYS = new Set(['id', 'title', 'end']);
+
+function snapshotPath(yamlPath) {
+    return yamlPath.replace(/\.ya?ml$/, '') + '.snapshot.json';
+}
+
+function encodeDay(value) {
+    if (value === undefined) return null;
+    if (value instanceof Date && value.getTime() % DAY_MS === 0) return value.getTime() / DAY_MS;
+    return { raw: tagDates(value) };
+}
+
+function decodeDay(value) {
+    if (value === null || value === undefined) return undefined;
+    if (typeof value === 'number') return new Date(value * DAY_MS);
+    return reviveDates(value.raw);
+}
+
+// Plain JSON clone with Dates tagged so they survive the round trip
+function tagDates(value) {
+    if (value instanceof Date) return { $date: value.toISOString() };
+    if (Array.isArray(value)) return value.map(tagDates);
+    if (value && typeof value === 'object') {
+        const out = {};
+        for (const key of Object.keys(value)) out[key] = tagDates(value[key]);
+        return out;
+    }
+    return value;
+}
+
+function reviveDates(value) {
+    if (Array.isArray(value)) return value.map(reviveDates);
+    if (value && typeof value === 'object') {
+        if (typeof value.$date === 'string') return new Date(value.$date);
+        const out = {};
+        for (const key of Object.keys(value)) out[key] = reviveDates(value[key]);
+        return out;
+    }
+    return value;
+}
+
+// Keys not covered by the fixed layout, or undefined when there are none
+function extraKeys(record, known) {
+    let extra;
+    for (const key of Object.keys(record)) {
+        if (known.has(key)) continue;
+        if (!extra) extra = {};
+        extra[key] = tagDates(record[key]);
+    }
+    return extra;
+}
+
+function encode(data, sourceHash, schema = 'default') {
+    const strings = [];
+    const index = new Map();
+    const shapes = [];
+    const shapeIndex = new Map();
+    const shapeOf = record => {
+        const keys = Object.keys(record);
+        const key = keys.join('\n');
+        let i = shapeIndex.get(key);
+        if (i === undefined) {
+            i = shapes.length;
+            shapes.push(keys);
+            shapeIndex.set(key, i);
+        }
+        return i;
+    };
+    const intern = value => {
+        if (typeof value !== 'string') return value === undefined ? null : { raw: tagDates(value) };
+        let i = index.get(value);
+        if (i === undefined) {
+            i = strings.length;
+            strings.push(value);
+            index.set(value, i);
+        }
+        return i;
+    };
+    const objectives = (data.objectives || []).map(obj => {
+        const krs = (obj.krs || []).map(kr => {
+            const row = [shapeOf(kr), intern(kr.id), intern(kr.title), encodeDay(kr.end)];
+            const extra = extraKeys(kr, KR_KEYS);
+            if (extra) row.push(extra);
+            return row;
+        });
+        const row = [shapeOf(obj), intern(obj.id), intern(obj.title), intern(obj.owner), encodeDay(obj.end), obj.krs ? krs : null];
+        const extra = extraKeys(obj, OBJECTIVE_KEYS);
+        if (extra) row.push(extra);
+        return row;
+    });
+    const { objectives: _, ...rest } = data;
+    return { version: SNAPSHOT_VERSION, source: sourceHash, schema, strings, shapes, rest: tagDates(rest), objectives };
+}
+
+// Rebuild the object tree yaml.load would have produced, keys in source order
+function decode(snapshot) {
+    const { strings, shapes } = snapshot;
+    const lookup = i => (typeof i === 'number' ? strings[i] : i === null ? undefined : reviveDates(i.raw));
+    const decodeKr = row => {
+        const kr = {};
+        for (const key of shapes[row[0]]) {
+            if (key === 'id') kr.id = lookup(row[1]);
+            else if (key === 'title') kr.title = lookup(row[2]);
+            else if (key === 'end') kr.end = decodeDay(row[3]);
+            else kr[key] = reviveDates(row[4][key]);
+        }
+        return kr;
+    };
+    const objectives = snapshot.objectives.map(row => {
+        const obj = {};
+        for (const key of shapes[row[0]]) {
+            if (key === 'id') obj.id = lookup(row[1]);
+            else if (key === 'title') obj.title = lookup(row[2]);
+            else if (key === 'owner') obj.owner = lookup(row[3]);
+            else if (key === 'end') obj.end = decodeDay(row[4]);
+            else if (key === 'krs') obj.krs = row[5] && row[5].map(decodeKr);
+            else obj[key] = reviveDates(row[6][key]);
+        }
+        return obj;
+    });
+    return { ...reviveDates(snapshot.rest), objectives };
+}
+
+// Decoded data if the snapshot at `path` was compiled from `sourceHash` with `schema`,
+// else null
+function load(path, sourceHash, schema = 'default') {
+    let snapshot;
+    try {
+        snapshot = JSON.parse(fs.readFileSync(path, 'utf8'));
+    } catch (error) {
+        return null;
+    }
+    if (!snapshot || snapshot.version !== SNAPSHOT_VERSION || snapshot.source !== sourceHash || snapshot.schema !== schema) {
+        return null;
+    }
+    return decode(snapshot);
+}
+
+// Write the snapshot with `write(path, chunks)`, atomically by default
+function save(path, data, sourceHash, schema = 'default', write = writeAtomicSync) {
+    write(path, [JSON.stringify(encode(data, sourceHash, schema)) + '\n']);
+}
+
+module.exports = {
+    SNAPSHOT_VERSION,
+    snapshotPath,
+    encode,
+    decode,
+    load,
+    save
+};
@@ -0,0 +1,101 @@
+const fs = require('fs');
+const path = require('path');
+const { spawnSync } = require('child_process');
+const { hash } = require('./cache');
+const { removeSync } = require('./io');
+
+// Pre-rendered charts live in this directory next to ROADMAP.md, one file per
+// distinct Mermaid source, named by the source's hash
+const SVG_DIR = 'roadmap-svg';
+const SVG_NAME_RE = /^[0-9a-f]{40}\.svg$/;
+
+// Raised when pre-rendering is requested but no Mermaid CLI can be found
+class DependencyError extends Error {
+    constructor(message) {
+        super(message);
+        this.name = 'DependencyError';
+    }
+}
+
+function isExecutable(file) {
+    try {
+        fs.accessSync(file, fs.constants.X_OK);
+        return fs.statSync(file).isFile();
+    } catch (error) {
+        return false;
+    }
+}
+
+// Locate the Mermaid CLI: $MMDC, then a local node_modules/.bin/mmdc, then PATH
+function findRenderer() {
+    if (process.env.MMDC) return process.env.MMDC;
+    const local = path.join(__dirname, '..', 'node_modules', '.bin', 'mmdc');
+    if (isExecutable(local)) return local;
+    for (const dir of (process.env.PATH || '').split(path.delimiter)) {
+        if (dir && isExecutable(path.join(dir, 'mmdc'))) return path.join(dir, 'mmdc');
+    }
+    return null;
+}
+
+// SVG renderer for one run. render(source) returns the SVG file name for a Mermaid
+// source, running mmdc only when no file with that hash exists yet; prune(remove) then
+// removes SVGs no chart refers to any more. With `dryRun` (--check) it only names
+// the files: nothing is rendered or pruned, and no Mermaid CLI is needed.
+function svgRenderer(dir, renderer = findRenderer(), { dryRun = false } = {}) {
+    if (!renderer && !dryRun) {
+        throw new DependencyError('SVG pre-rendering needs the Mermaid CLI: `npm install -g @mermaid-js/mermaid-cli` or set $MMDC');
+    }
+    const used = new Set();
+    let rendered = 0;
+    return {
+        render(source) {
+            const name = `${hash(source)}.svg`;
+            const file = path.join(dir, name);
+            used.add(name);
+            if (dryRun || fs.existsSync(file)) return name;
+            fs.mkdirSync(dir, { recursive: true });
+            // Render to temporary files and rename, so an interrupted run never
+            // leaves a partial SVG under a valid hash
+            const input = `${file}.${process.pid}.mmd`;
+            const output = `${file}.${process.pid}.svg`;
+            fs.writeFileSync(input, source);
+            try {
+                const run = spawnSync(renderer, ['-i', input, '-o', output, '-q'], { encoding: 'utf8' });
+                if (run.error) throw run.error;
+                if (run.status !== 0) throw new Error(`mmdc failed for ${name}: ${(run.stderr || '').trim()}`);
+                fs.renameSync(output, file);
+            } finally {
+                fs.rmSync(input, { force: true });
+                fs.rmSync(output, { force: true });
+            }
+            rendered++;
+            return name;
+        },
+        prune(remove = removeSync) {
+            if (dryRun || !fs.existsSync(dir)) return;
+            for (const name of fs.readdirSync(dir)) {
+                if (SVG_NAME_RE.test(name) && !used.has(name)) remove(path.join(dir, name));
+            }
+        },
+        names: () => [...used],
+        stats: () => ({ rendered, reused: used.size - rendered })
+    };
+}
+
+// Markdown for a pre-rendered chart: the SVG image, with the Mermaid source kept in a
+// collapsed block for viewers (and diffs) that want it
+function svgChunks(src, alt, mermaidChunks) {
+    return [
+        `\n![${alt}](${src})\n\n<details>\n<summary>Mermaid source</summary>\n\n\`\`\`mermaid\n`,
+        ...mermaidChunks,
+        '```\n\n</details>\n'
+    ];
+}
+
+module.exports = {
+    SVG_DIR,
+    DependencyError,
+    findRenderer,
+    svgRenderer,
+    svgChunks
+};
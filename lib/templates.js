@@ -0,0 +1,164 @@
+const { day } = require('./model');
+const { escapeHtml } = require('./viewer');
+
+// Output dialects. Each part is a template with {{field|filter|...}} placeholders:
+//   header, footer        once per document (only {{label}}, the horizon label)
+//   objective, objectiveEnd  before and after each objective's KRs
+//   kr                    once per KR
+// Formats with a `file` can be written next to ROADMAP.md with --format. The Gantt
+// chart only has its header here: its bars follow the dependency schedule and are
+// laid out by ganttFragment().
+const FORMATS = {
+    timeline: {
+        header: 'timeline\n    title KairOS {{label}} Timeline\n',
+        objective: '    {{objective.id}}: {{objective.title}}\n',
+        kr: '        : {{kr.id}} {{kr.title|short}}\n'
+    },
+    gantt: {
+        header: 'gantt\n    title KairOS {{label}} Gantt Chart\n    dateFormat YYYY-MM-DD\n    axisFormat %b %Y\n'
+    },
+    legend: {
+        header: '| ID | Full Task Name | Due Date |\n|----|----------------|----------|\n',
+        kr: '| {{kr.id}} | {{kr.title|cell}} | {{kr.end}} |\n'
+    },
+    html: {
+        file: 'roadmap-table.html',
+        header: '<!DOCTYPE html>\n<html lang="en">\n<head>\n<meta charset="utf-8">\n' +
+            '<title>KairOS {{label|html}} Roadmap</title>\n</head>\n<body>\n<table>\n' +
+            '<thead><tr><th>ID</th><th>Key Result</th><th>Owner</th><th>Start</th><th>Due</th><th>Progress</th></tr></thead>\n',
+        objective: '<tbody>\n<tr><th colspan="6">{{objective.id|html}}: {{objective.title|html}}</th></tr>\n',
+        kr: '<tr><td>{{kr.id|html}}</td><td>{{kr.title|html}}</td><td>{{kr.owner|html}}</td>' +
+            '<td>{{kr.start}}</td><td>{{kr.end}}</td><td>{{kr.progress|percent}}</td></tr>\n',
+        objectiveEnd: '</tbody>\n',
+        footer: '</table>\n</body>\n</html>\n'
+    },
+    slack: {
+        file: 'roadmap-slack.txt',
+        header: '*KairOS {{label|slack}} Roadmap*\n',
+        objective: '\n*{{objective.id|slack}}: {{objective.title|slack}}*\n',
+        kr: '• `{{kr.id|slack}}` {{kr.title|slack}} (due {{kr.end}})\n'
+    }
+};
+
+// Formats that are written as files of their own
+const FILE_FORMATS = Object.keys(FORMATS).filter(name => FORMATS[name].file);
+
+const PARTS = ['header', 'objective', 'kr', 'objectiveEnd', 'footer'];
+const PLACEHOLDER_RE = /\{\{\s*([\w.]+)((?:\s*\|\s*\w+)*)\s*\}\}/g;
+
+// Column reads for each field, as JavaScript expressions over the model `m`, its string
+// table `s`, objective `o` and KR `k`. Missing strings read as ''.
+const FIELDS = {
+    label: 'label',
+    'objective.id': "(s[m.objId[o]] ?? '')",
+    'objective.title': "(s[m.objTitle[o]] ?? '')",
+    'objective.owner': "(s[m.objOwner[o]] ?? '')",
+    'objective.start': 'D(m.objStartDay[o])',
+    'objective.end': 'D(m.objEndDay[o])',
+    'kr.id': "(s[m.krId[k]] ?? '')",
+    'kr.title': "(s[m.krTitle[k]] ?? '')",
+    'kr.owner': "(s[m.krOwner[k]] ?? '')",
+    'kr.status': "(s[m.krStatus[k]] ?? '')",
+    'kr.priority': "(s[m.krPriority[k]] ?? '')",
+    'kr.category': "(s[m.krCategory[k]] ?? '')",
+    'kr.description': "(s[m.krDescription[k]] ?? '')",
+    'kr.start': 'D(m.krStartDay[k])',
+    'kr.end': 'D(m.krEndDay[k])',
+    'kr.progress': 'm.krProgress[k]'
+};
+
+// Which field prefixes each part can read
+const SCOPES = {
+    header: [''],
+    footer: [''],
+    objective: ['', 'objective.'],
+    objectiveEnd: ['', 'objective.'],
+    kr: ['', 'objective.', 'kr.']
+};
+
+const FILTERS = {
+    // KR titles are cut to 30 characters in the charts; the legends carry the full text
+    short: text => (text.length > 30 ? text.substring(0, 30) + '...' : text),
+    // Table cells can't contain the column separator
+    cell: text => String(text).replace(/[|]/g, ''),
+    html: escapeHtml,
+    slack: text => String(text).replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;'),
+    percent: value => (typeof value === 'number' && !isNaN(value) ? `${value}%` : '')
+};
+
+// JavaScript expression for one template part, with the fields and filters resolved
+function compilePart(name, template) {
+    const pieces = [];
+    let last = 0;
+    PLACEHOLDER_RE.lastIndex = 0;
+    let m;
+    while ((m = PLACEHOLDER_RE.exec(template)) !== null) {
+        const [placeholder, field, filterList] = m;
+        if (m.index > last) pieces.push(JSON.stringify(template.slice(last, m.index)));
+        const prefix = field.includes('.') ? field.slice(0, field.indexOf('.') + 1) : '';
+        if (!FIELDS[field] || !SCOPES[name].includes(prefix)) throw new Error(`Unknown field "${field}" in ${name} template`);
+        let expression = FIELDS[field];
+        for (const filter of filterList.split('|').map(f => f.trim()).filter(Boolean)) {
+            if (!FILTERS[filter]) throw new Error(`Unknown filter "${filter}" in ${name} template`);
+            expression = `f.${filter}(${expression})`;
+        }
+        pieces.push(expression);
+        last = m.index + placeholder.length;
+    }
+    if (last < template.length) pieces.push(JSON.stringify(template.slice(last)));
+    return pieces.length === 0 ? "''" : pieces.join(' + ');
+}
+
+// Templates compiled by their source, so watch and serve runs and every pair a batch
+// worker handles share one compilation
+const compiled = new Map();
+
+// Compile a format into render functions: header(label), footer(label), and
+// objective(model, o, label) for an objective and its KRs. Placeholders are resolved
+// into plain column reads and string concatenation once, here; rendering does no
+// template interpretation at all.
+function compile(format) {
+    const key = JSON.stringify(PARTS.map(part => format[part] || ''));
+    let result = compiled.get(key);
+    if (result) return result;
+    const part = name => compilePart(name, format[name] || '');
+    const code = `
+        return {
+            header: label => ${part('header')},
+            footer: label => ${part('footer')},
+            objective(m, o, label) {
+                const s = m.strings;
+                const out = [${part('objective')}];
+                for (let k = m.objKrOffset[o], end = m.objKrOffset[o + 1]; k < end; k++) out.push(${part('kr')});
+                out.push(${part('objectiveEnd')});
+                return out.join('');
+            }
+        };`;
+    result = new Function('f', 'D', code)(FILTERS, day);
+    compiled.set(key, result);
+    return result;
+}
+
+// Compiled format by name, for the formats in FORMATS
+function format(name) {
+    if (!FORMATS[name]) throw new Error(`Unknown format "${name}" (expected one of ${Object.keys(FORMATS).join(', ')})`);
+    return compile(FORMATS[name]);
+}
+
+// A whole document in format `name` as chunks: header, one per objective, footer
+function renderFormat(model, name, label) {
+    const render = format(name);
+    const chunks = [render.header(label)];
+    for (let o = 0; o < model.objectiveCount; o++) chunks.push(render.objective(model, o, label));
+    chunks.push(render.footer(label));
+    return chunks;
+}
+
+module.exports = {
+    FORMATS,
+    FILE_FORMATS,
+    FILTERS,
+    compile,
+    format,
+    renderFormat
+};
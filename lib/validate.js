@@ -0,0 +1,147 @@
+const schema = require('./schema');
+const { DataError } = require('./model');
+const { toEpochDay, formatDay } = require('./dates');
+
+// Problems past this many are counted but not listed
+const MAX_LISTED = 50;
+
+// Epoch day of a date value that passed the schema check, else null
+function validDay(value) {
+    if (value instanceof Date) return isNaN(value.getTime()) ? null : toEpochDay(value);
+    if (!schema.isDateString(value)) return null;
+    return toEpochDay(value);
+}
+
+// Checks the objectives in the same single pass that feeds them to the model: types
+// (the OKR schema), duplicate objective and KR ids (hash sets), start <= end, and
+// KR end <= objective end. finish() adds the checks that need the whole file, namely
+// objective end <= horizon and depends_on ids, then throws one DataError listing
+// every problem found.
+function createValidator() {
+    const problems = [];
+    const report = message => problems.push(message);
+    const objectiveIds = new Set();
+    // KR id -> ordinal, with the objective and position of each ordinal, so paths are
+    // only formatted for the KRs that have a problem
+    const krIds = new Map();
+    const krObjective = [];
+    const krPosition = [];
+    const dependencies = [];
+    // [where, day] of the ends that must fall within the horizon
+    const horizonEnds = [];
+    let index = 0;
+
+    const krPath = (o, i) => `objectives[${o}].krs[${i}]`;
+
+    function checkKr(kr, o, i, objEnd) {
+        if (kr.id !== undefined) {
+            const id = String(kr.id);
+            const first = krIds.get(id);
+            if (first !== undefined) {
+                report(`${krPath(o, i)}.id: duplicate KR id "${id}" (first used at ${krPath(krObjective[first], krPosition[first])})`);
+            } else {
+                krIds.set(id, krObjective.length);
+                krObjective.push(o);
+                krPosition.push(i);
+            }
+        }
+        const start = validDay(kr.start);
+        const end = validDay(kr.end);
+        if (kr.end === undefined && objEnd === null) report(`${krPath(o, i)}: no end date, and its objective has none either`);
+        // With no objective end to hold it, the KR's own end is checked against the horizon
+        if (end !== null && objEnd === null) horizonEnds.push([krPath(o, i), end]);
+        if (end !== null && objEnd !== null && end > objEnd) {
+            report(`${krPath(o, i)}.end: ${formatDay(end)} is after its objective's end ${formatDay(objEnd)}`);
+        }
+        if (start !== null && end !== null && start > end) {
+            report(`${krPath(o, i)}.start: ${formatDay(start)} is after its end ${formatDay(end)}`);
+        }
+        if (kr.depends_on !== undefined && kr.depends_on !== null) {
+            const ids = Array.isArray(kr.depends_on) ? kr.depends_on : String(kr.depends_on).split(/[,;]/);
+            for (const id of ids) {
+                const text = String(id).trim();
+                if (text) dependencies.push([krPath(o, i), text]);
+            }
+        }
+    }
+
+    function check(obj) {
+        const o = index++;
+        const where = `objectives[${o}]`;
+        schema.checkObjective(obj, where, report);
+        if (!schema.isMapping(obj)) return;
+        if (obj.id !== undefined) {
+            const id = String(obj.id);
+            if (objectiveIds.has(id)) report(`${where}.id: duplicate objective id "${id}"`);
+            objectiveIds.add(id);
+        }
+        const start = validDay(obj.start);
+        const end = validDay(obj.end);
+        if (end !== null) horizonEnds.push([where, end]);
+        if (start !== null && end !== null && start > end) report(`${where}.start: ${formatDay(start)} is after its end ${formatDay(end)}`);
+        if (!Array.isArray(obj.krs)) return;
+        for (let i = 0; i < obj.krs.length; i++) {
+            if (schema.isMapping(obj.krs[i])) checkKr(obj.krs[i], o, i, end);
+        }
+    }
+
+    return {
+        problems,
+
+        // Pass objectives through, checking each one. After the first problem the rest
+        // are still checked but no longer yielded, since the run is going to fail and
+        // the model builder can't take malformed values.
+        * objectives(source) {
+            for (const obj of source) {
+                check(obj);
+                if (problems.length === 0) yield obj;
+            }
+        },
+
+        finish(data) {
+            schema.checkHeader(data, report);
+            let horizon = null;
+            let horizonKey = null;
+            for (const key of Object.keys(schema.isMapping(data) ? data : {})) {
+                if (!key.startsWith('horizon_')) continue;
+                const value = validDay(data[key]);
+                if (value !== null && (horizon === null || value > horizon)) {
+                    horizon = value;
+                    horizonKey = key;
+                }
+            }
+            if (horizon !== null) {
+                for (const [where, end] of horizonEnds) {
+                    if (end > horizon) report(`${where}.end: ${formatDay(end)} is after ${horizonKey} ${formatDay(horizon)}`);
+                }
+            }
+            for (const [where, id] of dependencies) {
+                if (!krIds.has(id)) report(`${where}.depends_on: unknown KR "${id}"`);
+            }
+            if (problems.length === 0) return data;
+            const listed = problems.slice(0, MAX_LISTED).map(problem => `\n  - ${problem}`).join('');
+            const more = problems.length > MAX_LISTED ? `\n  ... and ${problems.length - MAX_LISTED} more` : '';
+            const error = new DataError(`${problems.length} problem${problems.length === 1 ? '' : 's'} found${listed}${more}`);
+            error.problems = problems;
+            throw error;
+        }
+    };
+}
+
+// Validate objectives and top-level data already in memory; returns the problems
+function validate(data) {
+    const validator = createValidator();
+    const objectives = schema.isMapping(data) && Array.isArray(data.objectives) ? data.objectives : [];
+    Array.from(validator.objectives(objectives));
+    try {
+        validator.finish(data);
+    } catch (error) {
+        if (error.name !== 'DataError') throw error;
+    }
+    return validator.problems;
+}
+
+module.exports = {
+    createValidator,
+    validate
+};
@@ -0,0 +1,136 @@
+const { NO_DAY, str } = require('./model');
+const { quarterOf } = require('./dates');
+
+// Sharded HTML viewer written next to ROADMAP.md
+const VIEWER_FILE = 'roadmap.html';
+const SHARD_MODES = ['objective', 'quarter'];
+const MERMAID_URL = 'https://cdn.jsdelivr.net/npm/mermaid@10/dist/mermaid.esm.min.mjs';
+
+function escapeHtml(text) {
+    return String(text).replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;').replace(/"/g, '&quot;');
+}
+
+// Quarter an objective belongs to: that of its end date, else of its latest KR
+function objectiveQuarter(model, o) {
+    let end = model.objEndDay[o];
+    if (end === NO_DAY) {
+        for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+            if (model.krEndDay[k] !== NO_DAY && (end === NO_DAY || model.krEndDay[k] > end)) end = model.krEndDay[k];
+        }
+    }
+    return end === NO_DAY ? 'Unscheduled' : quarterOf(end).label;
+}
+
+// Group objectives into shards, one per objective or per quarter: [{ key, label, objectives }]
+function shardObjectives(model, by) {
+    if (by === 'objective') {
+        const shards = [];
+        for (let o = 0; o < model.objectiveCount; o++) {
+            const id = str(model, model.objId[o]);
+            shards.push({ key: `o${o}`, label: `${id}: ${str(model, model.objTitle[o])}`, objectives: [o] });
+        }
+        return shards;
+    }
+    const groups = new Map();
+    for (let o = 0; o < model.objectiveCount; o++) {
+        const quarter = objectiveQuarter(model, o);
+        if (!groups.has(quarter)) groups.set(quarter, []);
+        groups.get(quarter).push(o);
+    }
+    // Chronological; YYYY-Qn labels sort as strings and "Unscheduled" goes last
+    return [...groups.keys()]
+        .sort((a, b) => (a === 'Unscheduled') - (b === 'Unscheduled') || (a < b ? -1 : a > b ? 1 : 0))
+        .map(quarter => ({ key: quarter.toLowerCase(), label: quarter, objectives: groups.get(quarter) }));
+}
+
+function krCount(model, objectives) {
+    return objectives.reduce((sum, o) => sum + model.objKrOffset[o + 1] - model.objKrOffset[o], 0);
+}
+
+// Mermaid timeline for one shard, from the objectives' cached timeline fragments
+function shardChart(model, render, shard) {
+    const chunks = [`timeline\n    title ${shard.label}\n`];
+    for (const o of shard.objectives) chunks.push(render(model, o).timeline);
+    return chunks.join('');
+}
+
+// Small timeline with one entry per shard, rendered first as the page overview
+function indexChart(model, shards, title) {
+    const lines = [`timeline\n    title ${title}\n`];
+    for (const shard of shards) {
+        const krs = krCount(model, shard.objectives);
+        const objectives = shard.objectives.length;
+        lines.push(`    ${shard.label.replace(/:/g, '')} : ${objectives} objective${objectives === 1 ? '' : 's'} : ${krs} KR${krs === 1 ? '' : 's'}\n`);
+    }
+    return lines.join('');
+}
+
+function shardSection(id, label, chart) {
+    return `<section class="shard" id="${id}">
+<h2>${escapeHtml(label)}</h2>
+<div class="chart"></div>
+<pre class="mermaid-source" hidden>${escapeHtml(chart)}</pre>
+</section>
+`;
+}
+
+const PAGE_HEAD = title => `<!DOCTYPE html>
+<html lang="en">
+<head>
+<meta charset="utf-8">
+<meta name="viewport" content="width=device-width, initial-scale=1">
+<title>${escapeHtml(title)}</title>
+<style>
+body { font-family: system-ui, sans-serif; margin: 0 auto; max-width: 1100px; padding: 1rem; color: #2d3748; }
+nav a { margin-right: 0.75rem; }
+.shard { margin: 2rem 0; }
+.shard .chart { min-height: 240px; overflow-x: auto; }
+</style>
+</head>
+<body>
+<h1>${escapeHtml(title)}</h1>
+`;
+
+// Each shard is laid out by Mermaid only once it comes near the viewport, so the
+// initial cost doesn't grow with the number of objectives
+const PAGE_TAIL = `<script type="module">
+import mermaid from '${MERMAID_URL}';
+mermaid.initialize({ startOnLoad: false });
+let count = 0;
+async function draw(shard) {
+    const source = shard.querySelector('.mermaid-source').textContent;
+    const { svg } = await mermaid.render(\`chart-\${count++}\`, source);
+    shard.querySelector('.chart').innerHTML = svg;
+}
+const observer = new IntersectionObserver(entries => {
+    for (const entry of entries) {
+        if (!entry.isIntersecting) continue;
+        observer.unobserve(entry.target);
+        draw(entry.target).catch(error => { entry.target.querySelector('.chart').textContent = error.message; });
+    }
+}, { rootMargin: '400px 0px' });
+document.querySelectorAll('.shard').forEach(shard => observer.observe(shard));
+</script>
+</body>
+</html>
+`;
+
+// Viewer page as chunks: the index chart, a jump list, then one lazily rendered
+// section per shard
+function viewerChunks(model, render, by, title) {
+    const shards = shardObjectives(model, by);
+    const chunks = [PAGE_HEAD(title)];
+    chunks.push(`<nav>${shards.map(shard => `<a href="#${shard.key}">${escapeHtml(shard.label)}</a>`).join('')}</nav>\n`);
+    chunks.push(shardSection('index', 'Overview', indexChart(model, shards, title)));
+    for (const shard of shards) chunks.push(shardSection(shard.key, shard.label, shardChart(model, render, shard)));
+    chunks.push(PAGE_TAIL);
+    return chunks;
+}
+
+module.exports = {
+    VIEWER_FILE,
+    SHARD_MODES,
+    escapeHtml,
+    shardObjectives,
+    viewerChunks
+};
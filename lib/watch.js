@@ -0,0 +1,68 @@
+const fs = require('fs');
+const path = require('path');
+const { performance } = require('perf_hooks');
+
+const DEBOUNCE_MS = 30;
+
+// Keep the process warm and re-sync whenever okrs.yml (or the CSV sheet) changes. js-yaml, the
+// renderers and the fragment cache stay loaded, so a save only re-parses the
+// file and re-renders the objectives whose content changed.
+//
+// The directory is watched rather than the file itself, because editors often
+// save by writing a new file and renaming it over the old one.
+function watchRoadmap(options = {}, { debounceMs = DEBOUNCE_MS, onSync = () => {}, onError = () => {} } = {}) {
+    const { updateRoadmap } = require('../sync-roadmap');
+    const sourcePath = sourceFile(options);
+    const dir = path.dirname(path.resolve(sourcePath));
+    const file = path.basename(sourcePath);
+    const state = { manifest: null };
+    let timer = null;
+
+    const sync = () => {
+        timer = null;
+        const start = performance.now();
+        try {
+            const result = updateRoadmap({ ...options, state });
+            onSync(result, performance.now() - start);
+        } catch (error) {
+            onError(error);
+        }
+    };
+
+    const watcher = fs.watch(dir, (event, filename) => {
+        if (filename && filename !== file) return;
+        // Bursts of events for one save collapse into a single sync
+        if (timer) clearTimeout(timer);
+        timer = setTimeout(sync, debounceMs);
+    });
+    sync();
+
+    return {
+        close() {
+            if (timer) clearTimeout(timer);
+            watcher.close();
+        }
+    };
+}
+
+// The file a sync reads: the CSV sheet when given, okrs.yml otherwise
+function sourceFile(options) {
+    return options.csvPath || options.yamlPath || 'okrs.yml';
+}
+
+// CLI: node sync-roadmap.js --watch [sync flags]
+function main(args) {
+    const { describeResult, parseSyncFlags } = require('../sync-roadmap');
+    const { classifyError } = require('./preflight');
+    const options = parseSyncFlags(args);
+    console.log(`👀 Watching ${sourceFile(options)} for changes (Ctrl+C to stop)`);
+    watchRoadmap(options, {
+        onSync: (result, ms) => console.log(`🔄 Roadmap ${describeResult(result)} [${ms.toFixed(1)} ms]`),
+        onError: error => console.error(`❌ ${classifyError(error).message}`)
+    });
+}
+
+module.exports = {
+    watchRoadmap,
+    main
+};
@@ -0,0 +1,111 @@
+const fs = require('fs');
+const { StringDecoder } = require('string_decoder');
+const yaml = require('js-yaml');
+
+const CHUNK_SIZE = 64 * 1024;
+
+// Files above this size are streamed by default instead of loaded whole
+const STREAM_THRESHOLD = 4 * 1024 * 1024;
+
+// Yield the lines of a file (without trailing newline), reading fixed-size chunks
+function* readLines(path) {
+    const fd = fs.openSync(path, 'r');
+    const buffer = Buffer.alloc(CHUNK_SIZE);
+    const decoder = new StringDecoder('utf8');
+    let carry = '';
+    try {
+        let bytes;
+        while ((bytes = fs.readSync(fd, buffer, 0, CHUNK_SIZE, null)) > 0) {
+            const text = carry + decoder.write(buffer.subarray(0, bytes));
+            const lines = text.split('\n');
+            carry = lines.pop();
+            for (const line of lines) yield line;
+        }
+        carry += decoder.end();
+        if (carry) yield carry;
+    } finally {
+        fs.closeSync(fd);
+    }
+}
+
+function indentOf(line) {
+    return line.length - line.trimStart().length;
+}
+
+function isBlankOrComment(line) {
+    const trimmed = line.trim();
+    return trimmed === '' || trimmed.startsWith('#');
+}
+
+// Stream a roadmap YAML file. `objectives` yields one parsed objective at a time
+// from the block sequence under `objectives:`; only that item's text and tree are
+// alive at once. The remaining top-level keys (north_star, horizons, ...) are
+// collected as text and parsed once the sequence has been fully consumed, via `rest()`.
+function streamRoadmap(path, loadOptions) {
+    const restLines = [];
+    let restData = null;
+    let consumed = false;
+
+    function* objectives() {
+        let inSequence = false;
+        let itemIndent = -1;
+        let item = [];
+        const flush = function* () {
+            if (item.length === 0) return;
+            const parsed = yaml.load(item.join('\n'), loadOptions);
+            item = [];
+            if (Array.isArray(parsed)) yield* parsed;
+        };
+        for (const line of readLines(path)) {
+            if (inSequence) {
+                if (isBlankOrComment(line)) {
+                    if (item.length > 0) item.push(line);
+                    continue;
+                }
+                const indent = indentOf(line);
+                const startsItem = line.trimStart().startsWith('-');
+                if (itemIndent === -1 && startsItem) itemIndent = indent;
+                if (startsItem && indent === itemIndent) {
+                    yield* flush();
+                    item.push(line);
+                    continue;
+                }
+                if (indent > itemIndent && item.length > 0) {
+                    item.push(line);
+                    continue;
+                }
+                // Back at the top level: the sequence is over
+                yield* flush();
+                inSequence = false;
+            }
+            if (/^objectives:\s*(#.*)?$/.test(line)) {
+                inSequence = true;
+                itemIndent = -1;
+            } else {
+                restLines.push(line);
+            }
+        }
+        yield* flush();
+        consumed = true;
+        restData = yaml.load(restLines.join('\n'), loadOptions) || {};
+        // Flow-style or otherwise non-block objectives end up in the rest; emit them as-is
+        if (Array.isArray(restData.objectives)) {
+            yield* restData.objectives;
+            delete restData.objectives;
+        }
+    }
+
+    return {
+        objectives: objectives(),
+        rest() {
+            if (!consumed) throw new Error('rest() is only available after all objectives have been read');
+            return restData;
+        }
+    };
+}
+
+module.exports = {
+    STREAM_THRESHOLD,
+    readLines,
+    streamRoadmap
+};
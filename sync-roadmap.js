@@ -1,69 +1,647 @@
 #!/usr/bin/env node
 
+// Fail fast with a diagnostic when dependencies are missing, before requiring them
+if (require.main === module) require('./lib/preflight').checkDependencies();
+
 const fs = require('fs');
+const path = require('path');
 const yaml = require('js-yaml');
+const sections = require('./lib/sections');
+const cache = require('./lib/cache');
+const yamlStream = require('./lib/yaml-stream');
+const snapshot = require('./lib/snapshot');
+const okrYaml = require('./lib/schema');
+const csvSource = require('./lib/csv');
+const query = require('./lib/query');
+const rollups = require('./lib/rollups');
+const svg = require('./lib/svg');
+const viewer = require('./lib/viewer');
+const profile = require('./lib/profile');
+const io = require('./lib/io');
+const history = require('./lib/history');
+const graph = require('./lib/graph');
+const horizons = require('./lib/horizons');
+const validate = require('./lib/validate');
+const diff = require('./lib/diff');
+const templates = require('./lib/templates');
+const exporter = require('./lib/export');
+const federate = require('./lib/federate');
+const { formatDate, toEpochDay, formatDay, quarterOf } = require('./lib/dates');
+const { buildModel, str, day, NO_DAY } = require('./lib/model');
+
+// Rendered fragments and input/output hashes from the last run, kept next to okrs.yml
+const CACHE_FILE = '.roadmap-cache.json';
+
+// The timeline, legend and chart headers come from compiled templates (lib/templates.js)
+const TIMELINE = templates.format('timeline');
+const GANTT = templates.format('gantt');
+const LEGEND = templates.format('legend');
+const shortTitle = templates.FILTERS.short;
+
+// Timeline lines for objective `o` of the model
+function timelineFragment(model, o) {
+    return TIMELINE.objective(model, o);
+}
+
+// Gantt task names and ids can't contain the characters Mermaid uses as separators
+function ganttLabel(text) {
+    return String(text).replace(/[:;#]/g, '');
+}
+
+function ganttId(id) {
+    return String(id).replace(/[^\w-]/g, '_');
+}
+
+// Gantt section for objective `o`: one bar per KR running from the objective's
+// start to the KR's end, and a milestone on the objective's end. Objectives start at
+// their own `start` if set, otherwise at the beginning of the quarter they end in.
+// A KR without a usable start is drawn as a milestone on its end date.
+// With a dependency `schedule` (lib/graph.js), KRs that take part in it are drawn at
+// their projected dates, tagged crit on the critical path and labelled with any slip.
+function ganttFragment(model, o, schedule = null) {
+    const objId = str(model, model.objId[o]);
+    const objEnd = day(model.objEndDay[o]);
+    const objStart = model.objStartDay[o] !== NO_DAY ? day(model.objStartDay[o]) : objEnd && day(quarterOf(model.objEndDay[o]).start);
+    const lines = [`    section ${ganttLabel(objId)} ${ganttLabel(str(model, model.objTitle[o]))}\n`];
+    for (let k = model.objKrOffset[o]; k < model.objKrOffset[o + 1]; k++) {
+        const krId = str(model, model.krId[k]);
+        let label = `${ganttLabel(krId)} ${ganttLabel(shortTitle(str(model, model.krTitle[k])))}`;
+        let tags = '';
+        let start;
+        let end;
+        if (schedule && schedule.scheduled(k)) {
+            start = day(schedule.start[k]);
+            end = day(schedule.end[k]);
+            const slip = schedule.end[k] - schedule.plannedEnd[k];
+            if (slip > 0) label += ` (+${slip}d)`;
+            if (schedule.critical[k]) tags = 'crit, ';
+        } else {
+            end = day(model.krEndDay[k]) || objEnd;
+            if (!end) continue;
+            start = model.krStartDay[k] !== NO_DAY ? day(model.krStartDay[k]) : objStart;
+        }
+        if (start && start < end) {
+            lines.push(`    ${label} :${tags}${ganttId(krId)}, ${start}, ${end}\n`);
+        } else {
+            lines.push(`    ${label} :${tags}milestone, ${ganttId(krId)}, ${end}, 0d\n`);
+        }
+    }
+    if (objEnd) lines.push(`    ${ganttLabel(objId)} due :milestone, ${ganttId(objId)}_end, ${objEnd}, 0d\n`);
+    return lines.join('');
+}
 
-// Read the YAML file
-const yamlContent = fs.readFileSync('okrs.yml', 'utf8');
-const data = yaml.load(yamlContent);
+// Legend rows for objective `o`
+function legendFragment(model, o) {
+    return LEGEND.objective(model, o);
+}
 
-// Helper to format date as YYYY-MM-DD
-function formatDate(dateStr) {
-    if (!dateStr) return '';
-    const d = new Date(dateStr);
-    return d.toISOString().slice(0, 10);
+// All fragments for objective `o`; this is the unit cached between runs
+function renderObjective(model, o, schedule = null) {
+    return { timeline: timelineFragment(model, o), gantt: ganttFragment(model, o, schedule), legend: legendFragment(model, o) };
+}
+
+// Chart headers for a horizon label such as 2025 (see lib/horizons.js)
+const timelineHeader = TIMELINE.header;
+const ganttHeader = GANTT.header;
+const LEGEND_HEADER = LEGEND.header('');
+
+// Timeline chart as a sequence of chunks: the header, then one fragment per objective
+function* timelineChunks(model, render = renderObjective, label = horizons.horizonLabel(null, model)) {
+    yield timelineHeader(label);
+    for (let o = 0; o < model.objectiveCount; o++) yield render(model, o).timeline;
+}
+
+// Gantt chart as a sequence of chunks
+function* ganttChunks(model, render = renderObjective, label = horizons.horizonLabel(null, model)) {
+    yield ganttHeader(label);
+    for (let o = 0; o < model.objectiveCount; o++) yield render(model, o).gantt;
+}
+
+// Legend table as a sequence of chunks
+function* legendChunks(model, render = renderObjective) {
+    yield LEGEND_HEADER;
+    for (let o = 0; o < model.objectiveCount; o++) yield render(model, o).legend;
 }
 
 // Generate Mermaid timeline chart from YAML data
 function generateTimelineChart(objectives) {
-    let timeline = `timeline\n    title KairOS 2025 Timeline\n`;
-    objectives.forEach(obj => {
-        timeline += `    ${obj.id}: ${obj.title}\n`;
-        if (obj.krs && obj.krs.length > 0) {
-            obj.krs.forEach(kr => {
-                timeline += `        : ${kr.id} ${kr.title.length > 30 ? kr.title.substring(0, 30) + '...' : kr.title}\n`;
-            });
-        }
-    });
-    return timeline;
+    return Array.from(timelineChunks(buildModel(objectives))).join('');
+}
+
+// Generate Mermaid Gantt chart from YAML data
+function generateGanttChart(objectives) {
+    return Array.from(ganttChunks(buildModel(objectives))).join('');
 }
 
 // Generate legend table for all KRs
 function generateLegendTable(objectives) {
-    let table = `| ID | Full Task Name | Due Date |\n|----|----------------|----------|\n`;
-    objectives.forEach(obj => {
-        if (obj.krs && obj.krs.length > 0) {
-            obj.krs.forEach(kr => {
-                table += `| ${kr.id} | ${kr.title.replace(/[|]/g, '')} | ${formatDate(kr.end)} |\n`;
-            });
+    return Array.from(legendChunks(buildModel(objectives))).join('');
+}
+
+// Timeline, Gantt and legend chunk lists in a single traversal of the model. The
+// chunks are the (cached) fragment strings themselves; callers splice them into the
+// document or hand them to other writers without joining. `label` names the horizon
+// in the chart titles.
+function renderCharts(model, render = renderObjective, label = horizons.horizonLabel(null, model)) {
+    const timeline = [timelineHeader(label)];
+    const gantt = [ganttHeader(label)];
+    const legend = [LEGEND_HEADER];
+    for (let o = 0; o < model.objectiveCount; o++) {
+        const fragment = render(model, o);
+        timeline.push(fragment.timeline);
+        gantt.push(fragment.gantt);
+        legend.push(fragment.legend);
+    }
+    return { timeline, gantt, legend };
+}
+
+// Ingest a { objectives, rest() } source into the model and return { model, data }.
+// The objectives are validated on their way into the model, so the data is checked
+// in the same single pass that builds it and every problem is reported (as one
+// DataError) before anything is rendered.
+function ingest(source) {
+    const validator = validate.createValidator();
+    const model = buildModel(validator.objectives(source.objectives));
+    return { model, data: validator.finish(source.rest()) };
+}
+
+// Parse okrs.yml content, with the strict OKR schema when `okrSchema` is set. Types
+// are checked afterwards by the validator, in the same pass as everything else.
+function parseRoadmapData(yamlContent, okrSchema) {
+    return yaml.load(yamlContent, { schema: okrSchema ? okrYaml.OKR_SCHEMA : okrYaml.DEFAULT_SCHEMA });
+}
+
+// Stream okrs.yml, with the strict OKR schema when `okrSchema` is set
+function streamRoadmapData(yamlPath, okrSchema) {
+    return yamlStream.streamRoadmap(yamlPath, { schema: okrSchema ? okrYaml.OKR_SCHEMA : okrYaml.DEFAULT_SCHEMA });
+}
+
+// { objectives, rest() } source over top-level data already in memory. A malformed
+// objectives key is left for the validator to report.
+function dataSource(data) {
+    return { objectives: data && Array.isArray(data.objectives) ? data.objectives : [], rest: () => data };
+}
+
+// Open okrs.yml as { objectives, rest() }: either streamed one objective at a time,
+// or loaded whole. rest() returns the top-level keys once objectives are consumed.
+// With `useSnapshot`, an okrs.snapshot.json compiled from the same source with the same
+// schema replaces YAML parsing entirely. A new snapshot is left to the source's save(),
+// to be called once the data has been validated, and goes through `write` like every
+// other output.
+function openRoadmapData(yamlPath, yamlContent, sourceHash, { stream, useSnapshot, okrSchema, write }) {
+    if (stream) return streamRoadmapData(yamlPath, okrSchema);
+    const compiledPath = snapshot.snapshotPath(yamlPath);
+    const schema = okrSchema ? 'okr' : 'default';
+    const compiled = useSnapshot ? snapshot.load(compiledPath, sourceHash, schema) : null;
+    if (compiled) return dataSource(compiled);
+    const data = parseRoadmapData(yamlContent, okrSchema);
+    const source = dataSource(data);
+    if (useSnapshot) source.save = () => snapshot.save(compiledPath, data, sourceHash, schema, write);
+    return source;
+}
+
+// Update the roadmap with current data.
+// Returns the regenerated section names and how many objectives had to be re-rendered.
+// Large okrs.yml files are streamed; pass `stream` to force either mode.
+// `csvPath` reads a kairos-okr-data.csv style sheet instead of okrs.yml (always streamed).
+// `snapshot` keeps a compiled okrs.snapshot.json next to okrs.yml (not used when streaming).
+// `schema: 'okr'` parses with the minimal OKR schema instead of js-yaml's default one.
+// `stats` also writes progress rollups to roadmap-stats.json next to ROADMAP.md (or to
+// the given path), recomputing only the objectives that changed.
+// `history` appends the KRs' Progress values and the objective and overall rollups to
+// the month's chunk in okr-history/ next to okrs.yml (or the given directory), at most
+// once a day when the source is unchanged; read it back with readHistory().
+// `svg` pre-renders the charts with the Mermaid CLI into roadmap-svg/ and references
+// them from ROADMAP.md, keeping the Mermaid source as a fallback.
+// `shard: 'objective' | 'quarter'` also writes roadmap.html, a viewer with one chart per
+// shard that renders each chart only when it scrolls into view.
+// `formats` (e.g. ['html', 'slack']) also writes those dialects of the active horizon
+// next to ROADMAP.md, from the compiled templates in lib/templates.js.
+// `export` writes the versioned JSON/NDJSON bundle for SDK clients to roadmap-export/
+// next to ROADMAP.md (or the given directory), with gzipped copies; see lib/export.js.
+// `summary` writes roadmap-summary.json next to ROADMAP.md (or to the given path), the
+// installation's pre-sorted KRs and rollups for an org-wide --federate roadmap. It is
+// named by `installation`, else the okrs.yml `installation` key, else its directory.
+// `state` lets long-running callers keep the cache manifest in memory between runs; it
+// also receives the current document chunks, and the model, its dependency schedule
+// and the top-level data whenever the source had to be parsed.
+// `profiler` (from lib/profile.js) records a span and heap delta for every stage.
+// `inputs` ({ yamlContent, roadmap, manifest, sourceHash }) and `write`, `append`,
+// `remove` and `patch` (see io.deferredWriter()) let syncRoadmap() do the I/O itself;
+// by default files are read here and written synchronously, atomically except for
+// history appends and --diff patches.
+// `check` writes nothing (no stats, history or SVG rendering either) and only reports
+// whether ROADMAP.md is out of date; `diff` patches just the changed byte ranges of
+// ROADMAP.md in place. Both add `drift` and a structural `diff` (lib/diff.js) of
+// ROADMAP.md to the result.
+function updateRoadmap({
+    yamlPath = 'okrs.yml',
+    csvPath = null,
+    mdPath = 'ROADMAP.md',
+    cachePath = path.join(path.dirname(csvPath || yamlPath), CACHE_FILE),
+    stream = csvPath !== null || fs.statSync(yamlPath).size > yamlStream.STREAM_THRESHOLD,
+    snapshot: useSnapshot = false,
+    schema = 'default',
+    stats = false,
+    history: keepHistory = false,
+    svg: preRender = false,
+    shard = null,
+    formats = [],
+    export: exportTo = false,
+    summary: writeSummary = false,
+    installation = null,
+    state = null,
+    profiler = profile.NO_PROFILE,
+    inputs = null,
+    write: writeFile = io.writeAtomicSync,
+    append: appendFile = io.appendSync,
+    remove: removeFile = io.removeSync,
+    patch: patchInPlace = null,
+    check = false,
+    diff: showDiff = false
+} = {}) {
+    const span = profiler.span;
+    const skip = () => {};
+    const write = check ? skip : writeFile;
+    const append = check ? skip : appendFile;
+    const remove = check ? skip : removeFile;
+    const patch = check ? skip : patchInPlace || ((file, plan, original, chunks) => {
+        if (io.patchSync(file, plan, original) === -1) write(file, chunks);
+    });
+    if (shard && !viewer.SHARD_MODES.includes(shard)) {
+        throw new Error(`Unknown shard mode "${shard}" (expected ${viewer.SHARD_MODES.join(' or ')})`);
+    }
+    for (const name of formats) {
+        if (!templates.FILE_FORMATS.includes(name)) {
+            throw new Error(`Unknown format "${name}" (expected ${templates.FILE_FORMATS.join(' or ')})`);
+        }
+    }
+    const okrSchema = schema === 'okr';
+    const statsPath = !check && stats && (typeof stats === 'string' ? stats : path.join(path.dirname(mdPath), rollups.STATS_FILE));
+    const historyDir = !check && keepHistory &&
+        (typeof keepHistory === 'string' ? keepHistory : path.join(path.dirname(csvPath || yamlPath), history.HISTORY_DIR));
+    const today = toEpochDay(new Date());
+    const { yamlContent, manifest, roadmap } = inputs || span('read', () => ({
+        yamlContent: stream ? null : fs.readFileSync(yamlPath, 'utf8'),
+        manifest: (state && state.manifest) || cache.loadManifest(cachePath),
+        roadmap: fs.readFileSync(mdPath, 'utf8')
+    }));
+    const { sourceHash, outputHash } = span('hash', () => ({
+        sourceHash: (inputs && inputs.sourceHash) || (stream ? cache.hashFile(csvPath || yamlPath) : cache.hash(yamlContent)),
+        outputHash: cache.hash(roadmap)
+    }));
+    // Nothing to do if the source is unchanged and ROADMAP.md is still what we last wrote.
+    // Rollups estimate progress from dates, so they are also refreshed once a day.
+    const statsCurrent = !statsPath || (manifest.statsAsOf === formatDay(today) && fs.existsSync(statsPath));
+    const historyCurrent = !historyDir || manifest.historyAsOf === formatDay(today);
+    const summaryPath = !check && writeSummary &&
+        (typeof writeSummary === 'string' ? writeSummary : path.join(path.dirname(mdPath), federate.SUMMARY_FILE));
+    const summaryCurrent = !summaryPath || (manifest.summaryAsOf === formatDay(today) && fs.existsSync(summaryPath));
+    const svgDir = path.join(path.dirname(mdPath), svg.SVG_DIR);
+    const svgCurrent = preRender
+        ? Array.isArray(manifest.svgs) && manifest.svgs.every(name => fs.existsSync(path.join(svgDir, name)))
+        : !manifest.svgs;
+    const viewerPath = path.join(path.dirname(mdPath), viewer.VIEWER_FILE);
+    const viewerCurrent = !shard || (manifest.shard === shard && fs.existsSync(viewerPath));
+    const formatPath = name => path.join(path.dirname(mdPath), templates.FORMATS[name].file);
+    const formatsCurrent = formats.length === 0
+        ? !manifest.formats
+        : !!manifest.formats && Object.keys(manifest.formats).length === formats.length &&
+            formats.every(name => manifest.formats[name] && fs.existsSync(formatPath(name)));
+    const exportDir = exportTo && (typeof exportTo === 'string' ? exportTo : path.join(path.dirname(mdPath), exporter.EXPORT_DIR));
+    const exportCurrent = exportDir ? exporter.bundleCurrent(exportDir, manifest.export) : !manifest.export;
+    // Archived horizons only need a stat to confirm they are still what was frozen
+    const upToDate = manifest.source === sourceHash && manifest.output === outputHash &&
+        horizons.archiveCurrent(manifest.horizons, path.dirname(yamlPath));
+    const outputsCurrent = statsCurrent && historyCurrent && summaryCurrent && svgCurrent && viewerCurrent &&
+        formatsCurrent && exportCurrent;
+    if (upToDate && outputsCurrent) {
+        if (state) state.document = [roadmap];
+        const unchanged = { changed: [], rerendered: 0, objectives: null };
+        return check || showDiff ? { ...unchanged, drift: false, diff: null } : unchanged;
+    }
+
+    const source = span('parse', () => (csvPath
+        ? csvSource.streamCsvRoadmap(csvPath)
+        : openRoadmapData(yamlPath, yamlContent, sourceHash, { stream, useSnapshot, okrSchema, write })));
+    // The objectives (possibly streamed) are validated and ingested once into the
+    // columnar model that every generator reads from. Streamed sources are parsed
+    // during this stage.
+    const { model, data } = span('model', () => ingest(source));
+    // Only data the validator accepted is compiled into a snapshot
+    if (source.save) span('snapshot', source.save);
+    const snapshotSaved = Boolean(source.save);
+    // KRs with depends_on are scheduled through the dependency graph
+    const schedule = span('graph', () => graph.scheduleOf(model));
+    // Objectives whose content hash (and projected schedule) is unchanged reuse their
+    // cached fragments, so a slip only re-renders the objectives downstream of it
+    const fragments = cache.fragmentCache(manifest.objectives);
+    const render = schedule
+        ? (m, o) => fragments.get(m.objHash[o] + schedule.signature(o), () => renderObjective(m, o, schedule))
+        : (m, o) => fragments.get(m.objHash[o], () => renderObjective(m, o));
+    const label = horizons.horizonLabel(data, model);
+    const charts = span('render', () => renderCharts(model, render, label));
+    // Archived horizons are spliced in from their frozen renders, oldest first, each
+    // as its own chart ahead of the active one
+    const archive = span('archive', () => horizons.archivedHorizons(data, path.dirname(yamlPath), manifest.horizons, { schema }));
+    const horizonCharts = [
+        ...archive.horizons.map(h => ({ label: h.label, timeline: [h.timeline], gantt: [h.gantt] })),
+        { label, timeline: charts.timeline, gantt: charts.gantt }
+    ];
+    // Only the marker-delimited regions are regenerated; the rest of ROADMAP.md is left alone.
+    // Both legends share the same chunks. Roadmaps without a Gantt section just skip it,
+    // and sources without a north star (CSV sheets) leave that region as it is.
+    const legend = ['\n', charts.legend[0], ...archive.horizons.map(h => h.legend), ...charts.legend.slice(1)];
+    const mermaidBlocks = chart => horizonCharts.flatMap(h => ['\n```mermaid\n', ...h[chart], '```\n']);
+    const regions = {
+        timeline: mermaidBlocks('timeline'),
+        legend,
+        gantt: mermaidBlocks('gantt'),
+        'gantt-legend': legend
+    };
+    // SVGs are named by the hash of their Mermaid source, so mmdc only runs for charts
+    // whose source changed
+    const svgs = preRender ? svg.svgRenderer(svgDir, undefined, { dryRun: check }) : null;
+    if (svgs) {
+        span('svg', () => {
+            const image = (chunks, alt) => svg.svgChunks(`${svg.SVG_DIR}/${svgs.render(chunks.join(''))}`, alt, chunks);
+            regions.timeline = horizonCharts.flatMap(h => image(h.timeline, `KairOS ${h.label} Timeline`));
+            regions.gantt = horizonCharts.flatMap(h => image(h.gantt, `KairOS ${h.label} Gantt Chart`));
+        });
+    }
+    if (data.north_star) regions['north-star'] = `\n> **North Star**: ${String(data.north_star).trim()}\n`;
+    const result = sections.updateFile(mdPath, regions, roadmap, {
+        optional: ['gantt', 'gantt-legend'],
+        write,
+        patch: showDiff,
+        writePatch: patch,
+        span
+    });
+    const nextManifest = {
+        version: cache.CACHE_VERSION,
+        source: sourceHash,
+        output: cache.hashChunks(result.chunks),
+        objectives: fragments.entries()
+    };
+    if (archive.horizons.length > 0) nextManifest.horizons = archive.entries;
+    const changed = result.changed.slice();
+    if (snapshotSaved) changed.push('snapshot');
+    // Generated files other than ROADMAP.md are compared by the hash recorded last time
+    // instead of being read back
+    const writeIfChanged = (name, file, chunks, previousHash) => {
+        const contentHash = cache.hashChunks(chunks);
+        if (contentHash !== previousHash || !fs.existsSync(file)) {
+            write(file, chunks);
+            changed.push(name);
+        }
+        return contentHash;
+    };
+    if (shard) {
+        // The shards reuse the fragments rendered above
+        span('viewer', () => {
+            const chunks = viewer.viewerChunks(model, render, shard, `KairOS ${label} Roadmap`);
+            nextManifest.viewerHash = writeIfChanged('viewer', viewerPath, chunks, manifest.viewerHash);
+        });
+        nextManifest.shard = shard;
+    }
+    if (formats.length > 0) {
+        span('formats', () => {
+            nextManifest.formats = {};
+            for (const name of formats) {
+                const previousHash = manifest.formats && manifest.formats[name];
+                nextManifest.formats[name] = writeIfChanged(name, formatPath(name), templates.renderFormat(model, name, label), previousHash);
+            }
+        });
+    }
+    if (exportDir) {
+        span('export', () => {
+            const bundle = exporter.exportBundle(model, { dir: exportDir, label, previous: manifest.export });
+            for (const { file, chunks } of bundle.files) write(file, chunks);
+            if (bundle.files.length > 0) changed.push('export');
+            if (!check) exporter.pruneBundle(exportDir, bundle.entries, remove);
+            nextManifest.export = bundle.entries;
+        });
+    }
+    if (svgs) {
+        svgs.prune(remove);
+        nextManifest.svgs = svgs.names();
+    }
+    // Per-objective rollups are keyed by content hash and day, like the fragments
+    const asOf = formatDay(today);
+    let perObjective = null;
+    if (statsPath || historyDir || summaryPath) {
+        const partials = cache.fragmentCache(manifest.rollups);
+        perObjective = [];
+        for (let o = 0; o < model.objectiveCount; o++) {
+            perObjective.push(partials.get(`${model.objHash[o]}@${asOf}`, () => rollups.objectiveRollup(model, o, today)));
+        }
+        nextManifest.rollups = partials.entries();
+    }
+    const combined = perObjective && rollups.combineRollups(perObjective, today);
+    if (statsPath) {
+        span('stats', () => {
+            const json = rollups.serializeStats(combined);
+            nextManifest.statsHash = writeIfChanged('stats', statsPath, [json], manifest.statsHash);
+            nextManifest.statsAsOf = asOf;
+        });
+    }
+    if (summaryPath) {
+        span('summary', () => {
+            const name = installation || data.installation || path.basename(path.dirname(path.resolve(csvPath || yamlPath)));
+            const json = federate.serializeSummary(federate.buildSummary(model, perObjective, { installation: String(name), label, asOf }));
+            nextManifest.summaryHash = writeIfChanged('summary', summaryPath, [json], manifest.summaryHash);
+            nextManifest.summaryAsOf = asOf;
+        });
+    }
+    if (historyDir) {
+        span('history', () => {
+            // KRs are recorded only when they carry a Progress value; their estimates
+            // follow from the dates and would only add a delta per KR per day
+            const progress = { overall: combined.overall.progress };
+            for (const objective of combined.objectives) progress[`objective:${objective.id}`] = objective.progress;
+            for (let k = 0; k < model.krCount; k++) {
+                if (!isNaN(model.krProgress[k])) progress[`kr:${str(model, model.krId[k])}`] = model.krProgress[k];
+            }
+            if (history.appendSample(historyDir, progress, Date.now(), append)) changed.push('history');
+            nextManifest.historyAsOf = asOf;
+        });
+    }
+    span('manifest', () => {
+        const json = cache.serializeManifest(nextManifest);
+        if (json !== cache.serializeManifest(manifest)) {
+            write(cachePath, [json]);
+            changed.push('manifest');
         }
     });
-    return table;
-}
-
-// Update the roadmap with current data
-function updateRoadmap() {
-    let roadmap = fs.readFileSync('ROADMAP.md', 'utf8');
-    // Remove any existing mermaid blocks (Gantt or timeline)
-    roadmap = roadmap.replace(/```mermaid[\s\S]*?```/g, '');
-    // Insert the timeline chart at the right place
-    const timelineChart = generateTimelineChart(data.objectives);
-    roadmap = roadmap.replace(/(## 📅 2025 Roadmap Overview[\s\S]*?\n---\n)/, `$1\n## 🕒 Timeline Overview\n\n\`\`\`mermaid\n${timelineChart}\`\`\`\n`);
-    // Add legend table after the timeline chart
-    const legendTable = generateLegendTable(data.objectives);
-    roadmap = roadmap.replace(/(\`\`\`mermaid[\s\S]*?\`\`\`)/, `$1\n\n#### 🗂️ Timeline Legend\n\n${legendTable}`);
-    // Update north star
-    const northStarRegex = /> \*\*North Star\*\*: .*/;
-    roadmap = roadmap.replace(northStarRegex, `> **North Star**: ${data.north_star}`);
-    fs.writeFileSync('ROADMAP.md', roadmap);
-    console.log('✅ Roadmap updated with Mermaid timeline and legend only!');
-}
-
-try {
-    require('js-yaml');
-    updateRoadmap();
-} catch (error) {
-    console.log('📦 Installing js-yaml...');
-    require('child_process').execSync('npm install js-yaml', { stdio: 'inherit' });
-    updateRoadmap();
+    const summary = { changed, rerendered: fragments.stats().misses, objectives: model.objectiveCount };
+    if (check || showDiff) {
+        // Drift is ROADMAP.md only; the other outputs are git-ignored, apart from the
+        // append-only okr-history/
+        summary.drift = nextManifest.output !== outputHash;
+        summary.diff = summary.drift ? span('diff', () => diff.diffDocuments(roadmap, result.chunks.join(''))) : null;
+    }
+    if (state && !check) Object.assign(state, { manifest: nextManifest, model, data, schedule, document: result.chunks });
+    return summary;
+}
+
+// Promise-returning updateRoadmap() for embedding in servers: okrs.yml (or the CSV
+// hash), ROADMAP.md and the cache manifest are read concurrently, and every output is
+// written with non-blocking I/O once rendering is done, including history appends,
+// export pruning and --diff patches. Parsing and rendering are still synchronous CPU
+// work between the two. The exception is `svg`: each chart not rendered before runs the
+// Mermaid CLI synchronously, which writes its SVG itself.
+async function syncRoadmap(options = {}) {
+    const { yamlPath = 'okrs.yml', csvPath = null, mdPath = 'ROADMAP.md', state = null } = options;
+    const sourcePath = csvPath || yamlPath;
+    const cachePath = options.cachePath || path.join(path.dirname(sourcePath), CACHE_FILE);
+    const stream = options.stream !== undefined
+        ? options.stream
+        : csvPath !== null || (await fs.promises.stat(yamlPath)).size > yamlStream.STREAM_THRESHOLD;
+    const [source, roadmap, manifest] = await Promise.all([
+        stream ? cache.hashFileAsync(sourcePath) : fs.promises.readFile(yamlPath, 'utf8'),
+        fs.promises.readFile(mdPath, 'utf8'),
+        (state && state.manifest) || cache.loadManifestAsync(cachePath)
+    ]);
+    const inputs = stream
+        ? { yamlContent: null, roadmap, manifest, sourceHash: source }
+        : { yamlContent: source, roadmap, manifest };
+    const writer = io.deferredWriter();
+    const result = updateRoadmap({
+        ...options,
+        cachePath,
+        stream,
+        inputs,
+        write: writer.write,
+        append: writer.append,
+        remove: writer.remove,
+        patch: writer.patch
+    });
+    await writer.flush();
+    return result;
+}
+
+// Load okrs.yml (or a CSV sheet with `csvPath`) without rendering, as { model, data }
+// where `data` holds the top-level keys other than objectives
+function loadSource({ yamlPath = 'okrs.yml', csvPath = null, schema = 'default' } = {}) {
+    const okrSchema = schema === 'okr';
+    let source;
+    if (csvPath) {
+        source = csvSource.streamCsvRoadmap(csvPath);
+    } else if (fs.statSync(yamlPath).size > yamlStream.STREAM_THRESHOLD) {
+        source = streamRoadmapData(yamlPath, okrSchema);
+    } else {
+        source = dataSource(parseRoadmapData(fs.readFileSync(yamlPath, 'utf8'), okrSchema));
+    }
+    return ingest(source);
+}
+
+// Load okrs.yml (or a CSV sheet with `csvPath`) into the columnar model without rendering
+function loadModel(options = {}) {
+    return loadSource(options).model;
+}
+
+// Query index over the KRs of okrs.yml or a CSV sheet (see lib/query.js). The source
+// is re-read only when it changes on disk, so this is cheap to call per request.
+function queryIndex(options = {}) {
+    const { yamlPath = 'okrs.yml', csvPath = null } = options;
+    return query.openIndex(path.resolve(csvPath || yamlPath), () => loadModel(options));
+}
+
+// One-line console summary of an updateRoadmap() result. `changed` lists the ROADMAP.md
+// regions and the other outputs written, including the cache manifest and snapshot.
+function describeResult(result) {
+    if (result.changed.length === 0) return 'already up to date';
+    return `updated (${result.changed.join(', ')}; ${result.rerendered}/${result.objectives} objectives re-rendered)`;
+}
+
+// updateRoadmap() options from CLI flags shared by single and batch runs
+function parseSyncFlags(args) {
+    const options = {};
+    if (args.includes('--stream')) options.stream = true;
+    if (args.includes('--snapshot')) options.snapshot = true;
+    if (args.includes('--okr-schema')) options.schema = 'okr';
+    if (args.includes('--stats')) options.stats = true;
+    if (args.includes('--history')) options.history = true;
+    if (args.includes('--svg')) options.svg = true;
+    if (args.includes('--check')) options.check = true;
+    if (args.includes('--diff')) options.diff = true;
+    if (args.includes('--export')) options.export = true;
+    if (args.includes('--summary')) options.summary = true;
+    const installationIndex = args.indexOf('--installation');
+    if (installationIndex !== -1 && args[installationIndex + 1]) options.installation = args[installationIndex + 1];
+    const profileIndex = args.indexOf('--profile');
+    if (profileIndex !== -1) {
+        const next = args[profileIndex + 1];
+        options.profile = next && !next.startsWith('--') ? next : profile.TRACE_FILE;
+    }
+    const formatIndex = args.indexOf('--format');
+    if (formatIndex !== -1 && args[formatIndex + 1]) options.formats = args[formatIndex + 1].split(',').filter(Boolean);
+    const shardIndex = args.indexOf('--shard');
+    if (shardIndex !== -1) options.shard = args[shardIndex + 1] || 'objective';
+    const csvIndex = args.indexOf('--csv');
+    if (csvIndex !== -1 && args[csvIndex + 1]) options.csvPath = args[csvIndex + 1];
+    return options;
+}
+
+module.exports = {
+    CACHE_FILE,
+    formatDate,
+    renderObjective,
+    generateTimelineChart,
+    generateGanttChart,
+    generateLegendTable,
+    timelineChunks,
+    ganttChunks,
+    legendChunks,
+    renderCharts,
+    buildModel,
+    updateRoadmap,
+    syncRoadmap,
+    loadSource,
+    loadModel,
+    validate: validate.validate,
+    queryIndex,
+    createQueryIndex: query.createIndex,
+    createGraph: graph.createGraph,
+    readHistory: history.readHistory,
+    describeResult,
+    parseSyncFlags
+};
+
+if (require.main === module) {
+    const args = process.argv.slice(2);
+    if (args[0] === '--batch') {
+        require('./lib/batch').main(args.slice(1));
+    } else if (args.includes('--watch')) {
+        require('./lib/watch').main(args);
+    } else if (args.includes('--serve')) {
+        require('./lib/serve').main(args);
+    } else if (args[0] === '--federate') {
+        federate.main(args.slice(1));
+    } else if (args.includes('--github')) {
+        require('./lib/github').main(args);
+    } else {
+        const options = parseSyncFlags(args);
+        try {
+            // Profiling wraps whichever mode runs
+            const profiler = options.profile ? profile.createProfiler() : null;
+            const result = profiler
+                ? profiler.span('sync', () => updateRoadmap({ ...options, profiler }))
+                : updateRoadmap(options);
+            if ((options.check || options.diff) && result.drift) {
+                console.log(options.check ? '❌ ROADMAP.md is out of date:' : '✅ Roadmap patched:');
+                for (const line of diff.describeDiff(result.diff)) console.log(line);
+                if (options.check) process.exitCode = require('./lib/preflight').EXIT.DRIFT;
+            } else {
+                console.log(`✅ Roadmap ${options.check ? 'is up to date' : describeResult(result)}`);
+            }
+            if (profiler) {
+                profiler.writeTrace(options.profile);
+                console.log(`⏱️  ${profiler.summary()}`);
+                console.log(`📈 Trace written to ${options.profile}`);
+            }
+        } catch (error) {
+            require('./lib/preflight').reportError(error);
+        }
+    }
 }
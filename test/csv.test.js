@@ -0,0 +1,64 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { readCsvRecords, csvObjectives } = require('../lib/csv');
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'okr-csv-'));
+test.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+
+let files = 0;
+function records(text) {
+    const file = path.join(dir, `${files++}.csv`);
+    fs.writeFileSync(file, text);
+    return Array.from(readCsvRecords(file));
+}
+
+function ids(text) {
+    const file = path.join(dir, `${files++}.csv`);
+    fs.writeFileSync(file, text);
+    return Array.from(csvObjectives(file), obj => [obj.id, ...obj.krs.map(kr => kr.id)]);
+}
+
+test('splits plain fields and records', () => {
+    assert.deepEqual(records('a,b,c\n1,2,3\n'), [['a', 'b', 'c'], ['1', '2', '3']]);
+});
+
+test('handles quoted commas, doubled quotes and line breaks', () => {
+    assert.deepEqual(records('"x, y","say ""hi""","two\nlines"\n'), [['x, y', 'say "hi"', 'two\nlines']]);
+});
+
+test('accepts CRLF, a missing final newline and empty fields', () => {
+    assert.deepEqual(records('a,,c\r\n,"",\r\nlast'), [['a', '', 'c'], ['', '', ''], ['last']]);
+});
+
+test('skips blank lines', () => {
+    assert.deepEqual(records('a\n\n\nb\n'), [['a'], ['b']]);
+});
+
+test('reads records that span read chunks', () => {
+    const long = 'x'.repeat(70 * 1024);
+    assert.deepEqual(records(`"${long}","é"\nend\n`), [[long, 'é'], ['end']]);
+});
+
+test('rejects an unterminated quoted field', () => {
+    assert.throws(() => records('a,"open\n'), /unterminated quoted field/);
+});
+
+test('keeps generated ids when rows are inserted', () => {
+    const [a, b] = ids('Objective,Task Name\nA,one\nA,two\nB,three\n');
+    const [, a2, b2] = ids('Objective,Task Name\nZ,new\nA,zero\nA,one\nA,two\nB,three\n');
+    assert.deepEqual([a2[0], ...a2.slice(2)], a);
+    assert.deepEqual(b2, b);
+});
+
+test('numbers a reappearing objective and a repeated task apart', () => {
+    const [[a, one, again], , [a2]] = ids('Objective,Task Name\nA,one\nA,one\nB,x\nA,y\n');
+    assert.equal(again, `${one}-2`);
+    assert.equal(a2, `${a}-2`);
+});
+
+test('takes ids from the ID and Objective ID columns', () => {
+    assert.deepEqual(ids('Objective ID,Objective,ID,Task Name\nQ1,A,Q1a,one\nQ1,A,,two\n')[0].slice(0, 2), ['Q1', 'Q1a']);
+});
@@ -0,0 +1,54 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { mergeSummaries, renderFederation } = require('../lib/federate');
+
+const TOTALS = { keyResults: 0, measured: 0, progressSum: 0, completed: 0, due: 0 };
+
+function summary(installation, krs) {
+    return { installation, objectives: [], totals: TOTALS, krs: krs.map(([due, id]) => [due, id, `${id} title`, 0]) };
+}
+
+test('merges pre-sorted summaries by due date, undated KRs last', () => {
+    const summaries = [
+        summary('a', [['2025-07-01', 'a1'], ['2025-09-30', 'a2'], [null, 'a3']]),
+        summary('b', []),
+        summary('c', [['2025-06-15', 'c1'], ['2025-07-01', 'c2'], ['2025-12-31', 'c3']]),
+        summary('d', [[null, 'd1']])
+    ];
+    const merged = [];
+    mergeSummaries(summaries, (s, kr) => merged.push(`${s.installation}:${kr[1]}`));
+    // Equal dates keep the order the summaries were given in
+    assert.deepEqual(merged, ['c:c1', 'a:a1', 'c:c2', 'a:a2', 'c:c3', 'a:a3', 'd:d1']);
+});
+
+test('matches a global sort on many installations', () => {
+    const summaries = [];
+    let seed = 7;
+    const random = () => (seed = (seed * 1103515245 + 12345) % 2147483648) / 2147483648;
+    for (let s = 0; s < 25; s++) {
+        const krs = [];
+        for (let i = 0; i < 40; i++) {
+            const day = random() < 0.1 ? null : `2025-${String(1 + Math.floor(random() * 12)).padStart(2, '0')}-${String(1 + Math.floor(random() * 28)).padStart(2, '0')}`;
+            krs.push([day, `k${i}`]);
+        }
+        krs.sort((x, y) => (x[0] === null) - (y[0] === null) || (x[0] < y[0] ? -1 : x[0] > y[0] ? 1 : 0));
+        summaries.push(summary(`i${s}`, krs));
+    }
+    const merged = [];
+    mergeSummaries(summaries, (s, kr) => merged.push([kr[0], s.installation, kr[1]]));
+    const expected = summaries
+        .flatMap((s, index) => s.krs.map((kr, i) => ({ due: kr[0] || '~', index, i, row: [kr[0], s.installation, kr[1]] })))
+        .sort((x, y) => (x.due < y.due ? -1 : x.due > y.due ? 1 : x.index - y.index || x.i - y.i))
+        .map(entry => entry.row);
+    assert.deepEqual(merged, expected);
+});
+
+test('groups the org timeline by due quarter', () => {
+    const regions = renderFederation([
+        summary('a', [['2025-07-01', 'a1'], ['2025-09-30', 'a2'], [null, 'a3']]),
+        summary('b', [['2025-10-01', 'b1']])
+    ], 'Org');
+    const timeline = regions.timeline.join('');
+    assert.match(timeline, /2025-Q3: Due in 2025-Q3\n {8}: a a1 a1 title\n {8}: a a2 a2 title\n {4}2025-Q4: Due in 2025-Q4\n {8}: b b1 b1 title\n {4}Unscheduled/);
+    assert.equal(regions.legend.length, 5);
+});
@@ -0,0 +1,111 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const { buildModel, str } = require('../lib/model');
+const { createGraph } = require('../lib/graph');
+
+// Q3h -> Q3i -> Q3j, as in okrs.yml, plus Q3a/Q3b -> Q3d and an unlinked KR
+function sample() {
+    return buildModel([
+        {
+            id: 'O1',
+            title: 'Firmware',
+            start: '2025-07-01',
+            end: '2025-09-30',
+            krs: [
+                { id: 'Q3a', title: 'a', end: '2025-07-10' },
+                { id: 'Q3b', title: 'b', end: '2025-07-15' },
+                { id: 'Q3d', title: 'd', end: '2025-07-25', depends_on: ['Q3a', 'Q3b'] },
+                { id: 'Q3h', title: 'h', end: '2025-08-08' },
+                { id: 'Q3i', title: 'i', end: '2025-08-15', depends_on: 'Q3h' },
+                { id: 'Q3j', title: 'j', end: '2025-08-30', depends_on: 'Q3i' },
+                { id: 'Q3x', title: 'x', end: '2025-09-01' }
+            ]
+        }
+    ]);
+}
+
+// Index of the KR with `id`
+function kr(model, id) {
+    return Array.from(model.krId).indexOf(model.strings.indexOf(id));
+}
+
+// Dependencies of KR k in the model, as KR indexes
+function deps(model, k) {
+    const result = [];
+    for (let j = model.krDepOffset[k]; j < model.krDepOffset[k + 1]; j++) result.push(Array.from(model.krId).indexOf(model.krDeps[j]));
+    return result;
+}
+
+// Projected dates of every KR from scratch, in topological order, from the graph's
+// planned starts and durations
+function rebuild(model, graph) {
+    const start = new Map();
+    const end = new Map();
+    for (const k of graph.order) {
+        let s = graph.plannedStart[k];
+        for (const dep of deps(model, k)) if (end.get(dep) > s) s = end.get(dep);
+        start.set(k, s);
+        end.set(k, s + graph.duration[k]);
+    }
+    return { start, end };
+}
+
+test('setEnd pushes downstream KRs and keeps their durations', () => {
+    const graph = createGraph(sample());
+    const before = graph.toJSON();
+    const changed = graph.setEnd('Q3h', '2025-08-20');
+    assert.deepEqual(changed.sort(), ['Q3h', 'Q3i', 'Q3j']);
+    const after = graph.toJSON();
+    assert.deepEqual(after.Q3i, { start: '2025-08-20', end: '2025-08-27', slip: 12, critical: true });
+    assert.deepEqual(after.Q3j, { start: '2025-08-27', end: '2025-09-11', slip: 12, critical: true });
+    assert.deepEqual(after.Q3d, before.Q3d);
+    assert.deepEqual(graph.criticalPath(), ['Q3h', 'Q3i', 'Q3j']);
+});
+
+test('setEnd matches a rebuild of the whole schedule', () => {
+    const model = sample();
+    const graph = createGraph(model);
+    for (const [id, date] of [['Q3h', '2025-08-20'], ['Q3a', '2025-07-30'], ['Q3h', '2025-08-01'], ['Q3i', '2025-09-05']]) {
+        graph.setEnd(id, date);
+        const expected = rebuild(model, graph);
+        for (const k of graph.order) {
+            assert.equal(graph.start[k], expected.start.get(k), `start of ${str(model, model.krId[k])} after ${id}`);
+            assert.equal(graph.end[k], expected.end.get(k), `end of ${str(model, model.krId[k])} after ${id}`);
+        }
+    }
+});
+
+test('addDependency reorders only what it must and rejects cycles', () => {
+    const model = sample();
+    const graph = createGraph(model);
+    // Q3a comes first in the order; making it depend on Q3j moves it after the chain
+    const changed = graph.addDependency('Q3a', 'Q3j');
+    assert.ok(changed.includes('Q3a') && changed.includes('Q3d'));
+    assert.equal(graph.edges, 5);
+    const after = graph.toJSON();
+    assert.equal(after.Q3a.start, '2025-08-30');
+    assert.ok(after.Q3d.slip > 0);
+    assert.deepEqual(graph.criticalPath(), ['Q3h', 'Q3i', 'Q3j', 'Q3a', 'Q3d']);
+
+    const order = Array.from(graph.order);
+    assert.throws(() => graph.addDependency('Q3h', 'Q3d'), /Dependency cycle/);
+    assert.deepEqual(Array.from(graph.order), order);
+    assert.equal(graph.edges, 5);
+    assert.throws(() => graph.addDependency('Q3x', 'Q3x'), /depends on itself/);
+});
+
+test('addDependency keeps the order topological', () => {
+    const model = sample();
+    const graph = createGraph(model);
+    graph.addDependency('Q3a', 'Q3j');
+    graph.addDependency('Q3h', 'Q3x');
+    const edges = [['Q3j', 'Q3a'], ['Q3x', 'Q3h']];
+    for (let k = 0; k < model.krCount; k++) {
+        for (const dep of deps(model, k)) edges.push([str(model, model.krId[dep]), str(model, model.krId[k])]);
+    }
+    const position = new Map(Array.from(graph.order, (k, i) => [k, i]));
+    assert.equal(position.size, model.krCount);
+    for (const [before, after] of edges) {
+        assert.ok(position.get(kr(model, before)) < position.get(kr(model, after)), `${before} before ${after}`);
+    }
+});
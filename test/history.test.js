@@ -0,0 +1,62 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { appendSample, listMonths, readHistory } = require('../lib/history');
+
+const DAY = 24 * 60 * 60 * 1000;
+const JULY = Date.UTC(2025, 6, 1);
+const AUGUST = Date.UTC(2025, 7, 1);
+
+const root = fs.mkdtempSync(path.join(os.tmpdir(), 'okr-history-'));
+test.after(() => fs.rmSync(root, { recursive: true, force: true }));
+
+let dirs = 0;
+function history() {
+    return path.join(root, String(dirs++));
+}
+
+function lines(dir, month) {
+    return fs.readFileSync(path.join(dir, `${month}.ndjson`), 'utf8').trim().split('\n').map(line => JSON.parse(line));
+}
+
+test('starts each month with a keyframe and then writes deltas', () => {
+    const dir = history();
+    assert.equal(appendSample(dir, { a: 10, b: 20 }, JULY), true);
+    assert.equal(appendSample(dir, { a: 10, b: 20 }, JULY + DAY), false);
+    assert.equal(appendSample(dir, { a: 15, b: 20, c: 5 }, JULY + 2 * DAY), true);
+    assert.equal(appendSample(dir, { a: 15, c: 7.5 }, JULY + 3 * DAY), true);
+    assert.equal(appendSample(dir, { a: 40 }, AUGUST), true);
+    assert.deepEqual(listMonths(dir), ['2025-07', '2025-08']);
+    const july = lines(dir, '2025-07');
+    assert.deepEqual(july[0], { t: JULY, k: 1, ids: ['a', 'b'], v: [100, 200] });
+    assert.deepEqual(july[1], { t: JULY + 2 * DAY, d: [[0, 50]], n: [['c', 50]] });
+    assert.deepEqual(july[2], { t: JULY + 3 * DAY, d: [[2, 25]], x: [1] });
+    assert.equal(lines(dir, '2025-08')[0].k, 1);
+});
+
+test('replays deltas back into the recorded values', () => {
+    const dir = history();
+    appendSample(dir, { a: 10, b: 20 }, JULY);
+    appendSample(dir, { a: 15, b: 20, c: 5 }, JULY + 2 * DAY);
+    appendSample(dir, { a: 15, c: 7.5 }, JULY + 3 * DAY);
+    appendSample(dir, { a: 15, b: 30, c: 7.5 }, JULY + 4 * DAY);
+    const { times, series } = readHistory(dir);
+    assert.deepEqual(times, [JULY, JULY + 2 * DAY, JULY + 3 * DAY, JULY + 4 * DAY]);
+    assert.deepEqual(series, {
+        a: [10, 15, 15, 15],
+        b: [20, 20, null, 30],
+        c: [null, 5, 7.5, 7.5]
+    });
+});
+
+test('carries the state at the start of a range over from earlier months', () => {
+    const dir = history();
+    appendSample(dir, { a: 10, b: 20 }, JULY);
+    appendSample(dir, { a: 25, b: 20 }, JULY + 10 * DAY);
+    appendSample(dir, { a: 60, b: 20 }, AUGUST + 5 * DAY);
+    const { times, series } = readHistory(dir, { from: '2025-08-01', to: '2025-08-31', ids: ['a'] });
+    assert.deepEqual(times, [AUGUST, AUGUST + 5 * DAY]);
+    assert.deepEqual(series, { a: [25, 60] });
+});
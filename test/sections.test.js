@@ -0,0 +1,70 @@
+const test = require('node:test');
+const assert = require('node:assert/strict');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const sections = require('../lib/sections');
+
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'okr-sections-'));
+test.after(() => fs.rmSync(dir, { recursive: true, force: true }));
+
+const DOC = '# Roadmap\n<!-- okr:a:start -->\nold a\n<!-- okr:a:end -->\nhand-written\n<!-- okr:b:start -->\nold b\n<!-- okr:b:end -->\ntail\n';
+
+let files = 0;
+function patch(original, bodies) {
+    const file = path.join(dir, `${files++}.md`);
+    fs.writeFileSync(file, original);
+    const { segments, chunks } = sections.splice(sections.tokenize(original), bodies);
+    const written = sections.patchFile(file, segments, original);
+    return { file, written, expected: chunks.join('') };
+}
+
+test('overwrites same-length regions in place', () => {
+    const { file, written, expected } = patch(DOC, { b: '\nnew b\n' });
+    assert.equal(written, Buffer.byteLength('\nnew b\n'));
+    assert.equal(fs.readFileSync(file, 'utf8'), expected);
+});
+
+test('rewrites from the first changed region and truncates when lengths differ', () => {
+    const { file, written, expected } = patch(DOC, { a: '\na\n', b: '\nlonger b than before\n' });
+    assert.equal(fs.readFileSync(file, 'utf8'), expected);
+    assert.equal(written, Buffer.byteLength(expected) - DOC.indexOf('\nold a'));
+    const shorter = patch(DOC, { b: '\n' });
+    assert.equal(fs.readFileSync(shorter.file, 'utf8'), shorter.expected);
+});
+
+test('counts multi-byte characters as bytes', () => {
+    const { file, expected } = patch(DOC.replace('old a', 'día a'), { a: '\nnew ä\n', b: ['\n', 'chunk b', '\n'] });
+    assert.equal(fs.readFileSync(file, 'utf8'), expected);
+});
+
+test('leaves a file that changed since it was read alone', () => {
+    const file = path.join(dir, 'changed.md');
+    fs.writeFileSync(file, `${DOC}more\n`);
+    const { segments } = sections.splice(sections.tokenize(DOC), { a: '\nnew a\n' });
+    assert.equal(sections.patchFile(file, segments, DOC), -1);
+    assert.equal(fs.readFileSync(file, 'utf8'), `${DOC}more\n`);
+});
+
+test('leaves a file edited to the same size since it was read alone', () => {
+    const file = path.join(dir, 'same-size.md');
+    const edited = DOC.replace('hand-written', 'HAND-WRITTEN');
+    fs.writeFileSync(file, edited);
+    const { segments } = sections.splice(sections.tokenize(DOC), { b: '\nnew b\n' });
+    assert.equal(sections.patchFile(file, segments, DOC), -1);
+    assert.equal(fs.readFileSync(file, 'utf8'), edited);
+});
+
+test('updateFile patches in place and falls back to write', () => {
+    const file = path.join(dir, 'update.md');
+    fs.writeFileSync(file, DOC);
+    const writes = [];
+    const write = (target, chunks) => writes.push(chunks.join(''));
+    const result = sections.updateFile(file, { a: '\nnew, longer a\n' }, DOC, { patch: true, write });
+    assert.deepEqual(result.changed, ['a']);
+    assert.deepEqual(writes, []);
+    assert.equal(fs.readFileSync(file, 'utf8'), result.chunks.join(''));
+    // DOC is stale now, so the patch is refused and the regular write is used
+    sections.updateFile(file, { a: '\nagain\n' }, DOC, { patch: true, write });
+    assert.deepEqual(writes, [DOC.replace('old a', 'again')]);
+});